@@ -0,0 +1,56 @@
+// Measures compileBatch throughput over many small files for increasing pool sizes.
+// With enough cores the files per second should grow close to linearly with threads.
+// The files are generated once in a directory under the system temporary directory.
+//
+// Build: g++ -std=c++17 -O2 bench/batch_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o batch_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+
+constexpr int FILE_COUNT = 2000;
+constexpr int DECLARATIONS_PER_FILE = 50;
+
+const std::vector<std::string> &inputFiles()
+{
+    static const std::vector<std::string> paths = []
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "mini_compiler_batch_bench";
+        std::filesystem::create_directories(directory);
+        std::vector<std::string> files;
+        for (int i = 0; i < FILE_COUNT; i++)
+        {
+            std::string path = (directory / ("unit" + std::to_string(i) + ".mc")).string();
+            std::ofstream out(path);
+            for (int j = 0; j < DECLARATIONS_PER_FILE; j++)
+            {
+                out << "int v" << j << " = " << i << " + " << j << " - " << (i + j) % 17 << ";\n";
+            }
+            files.push_back(path);
+        }
+        return files;
+    }();
+    return paths;
+}
+
+void BM_CompileBatch(benchmark::State &state)
+{
+    const std::vector<std::string> &files = inputFiles();
+    WorkStealingPool pool(static_cast<size_t>(state.range(0)));
+    DriverOptions options;
+    options.run = true;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(compileBatch(files, options, pool));
+    }
+    state.SetItemsProcessed(state.iterations() * files.size());
+}
+BENCHMARK(BM_CompileBatch)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+// Measures compiling a program whose declarations were seen before through the
+// CompileCache against the uncached pipeline of parsing, folding and compiling, and the
+// cost of a cold cache that misses on every declaration.
+//
+// Build: g++ -std=c++17 -O2 bench/cache_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o cache_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+constexpr int DECLARATION_COUNT = 10000;
+constexpr int TERMS_PER_DECLARATION = 50;
+
+std::string makeProgram()
+{
+    std::string code;
+    for (int i = 0; i < DECLARATION_COUNT; i++)
+    {
+        code += "int v" + std::to_string(i) + " = " + std::to_string(i);
+        for (int j = 1; j < TERMS_PER_DECLARATION; j++)
+        {
+            code += j % 2 ? " + " : " - ";
+            code += std::to_string(j * 7 % 101);
+        }
+        code += ";\n";
+    }
+    return code;
+}
+
+const std::string &program()
+{
+    static const std::string source = makeProgram();
+    return source;
+}
+
+void BM_CompileUncached(benchmark::State &state)
+{
+    const std::string &source = program();
+    for (auto _ : state)
+    {
+        Arena arena;
+        Interner interner;
+        Lexer lexer(source, interner);
+        Parser parser(lexer, arena);
+        std::vector<AstNode *> statements;
+        parser.parseProgram(statements);
+        for (AstNode *&statement : statements)
+        {
+            foldConstants(statement);
+        }
+        benchmark::DoNotOptimize(BytecodeCompiler().compile(statements));
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_CompileUncached)->Unit(benchmark::kMillisecond);
+
+void BM_CompileColdCache(benchmark::State &state)
+{
+    const std::string &source = program();
+    for (auto _ : state)
+    {
+        Interner interner;
+        CompileCache cache;
+        BytecodeProgram compiled;
+        benchmark::DoNotOptimize(compileWithCache(source, interner, cache, compiled));
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_CompileColdCache)->Unit(benchmark::kMillisecond);
+
+void BM_CompileWarmCache(benchmark::State &state)
+{
+    const std::string &source = program();
+    CompileCache cache;
+    {
+        Interner interner;
+        BytecodeProgram compiled;
+        compileWithCache(source, interner, cache, compiled);
+    }
+    for (auto _ : state)
+    {
+        Interner interner;
+        BytecodeProgram compiled;
+        benchmark::DoNotOptimize(compileWithCache(source, interner, cache, compiled));
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+    state.counters["hit_rate"] = double(cache.hits()) / double(cache.hits() + cache.misses());
+}
+BENCHMARK(BM_CompileWarmCache)->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
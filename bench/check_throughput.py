@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Fails when lexing or parsing throughput drops against a stored baseline.
+
+Runs bench/throughput_bench on the fixed corpus in bench/corpus, takes the median
+bytes_per_second of each benchmark over several repetitions, and compares it with
+bench/throughput_baseline.json. Exits with status 1 if any benchmark is slower than
+the baseline by more than the threshold, or if the baseline and the run do not cover
+the same benchmarks.
+
+Baselines only compare within one machine and compiler. After a deliberate change, or
+on a new machine, record a new one with --update and commit it with the change.
+
+Usage, from the repository root:
+    g++ -std=c++17 -O2 bench/throughput_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o throughput_bench
+    python3 bench/check_throughput.py ./throughput_bench [--threshold 0.1] [--update]
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_BASELINE = os.path.join(ROOT, "bench", "throughput_baseline.json")
+DEFAULT_CORPUS = os.path.join(ROOT, "bench", "corpus")
+
+
+def measure(binary, corpus, repetitions, min_time):
+    """Returns the median bytes_per_second of every benchmark, keyed by name."""
+    command = [
+        binary,
+        corpus,
+        "--benchmark_format=json",
+        "--benchmark_repetitions=%d" % repetitions,
+        "--benchmark_report_aggregates_only=true",
+        "--benchmark_min_time=%g" % min_time,
+    ]
+    report = json.loads(subprocess.run(command, check=True, stdout=subprocess.PIPE).stdout)
+    results = {}
+    for benchmark in report["benchmarks"]:
+        if benchmark.get("aggregate_name") == "median":
+            results[benchmark["run_name"]] = benchmark["bytes_per_second"]
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("binary", help="the built throughput_bench")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE)
+    parser.add_argument("--corpus", default=DEFAULT_CORPUS)
+    parser.add_argument("--threshold", type=float, default=0.1,
+                        help="largest allowed drop, as a fraction of the baseline (default 0.1)")
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument("--min-time", type=float, default=0.2, help="seconds per repetition")
+    parser.add_argument("--update", action="store_true", help="write the results as the new baseline")
+    args = parser.parse_args()
+
+    results = measure(args.binary, args.corpus, args.repetitions, args.min_time)
+    if args.update:
+        with open(args.baseline, "w") as out:
+            json.dump({name: round(value) for name, value in sorted(results.items())}, out, indent=2)
+            out.write("\n")
+        print("Wrote %d baselines to %s" % (len(results), args.baseline))
+        return 0
+
+    with open(args.baseline) as baseline_file:
+        baseline = json.load(baseline_file)
+    failed = False
+    for name in sorted(set(baseline) | set(results)):
+        if name not in results or name not in baseline:
+            print("%-32s missing from the %s" % (name, "run" if name not in results else "baseline"))
+            failed = True
+            continue
+        change = results[name] / baseline[name] - 1
+        regressed = change < -args.threshold
+        failed = failed or regressed
+        print("%-32s %8.1f MB/s %+7.1f%%%s" % (name, results[name] / 1e6, change * 100,
+                                              "  REGRESSION" if regressed else ""))
+    if failed:
+        print("Throughput check failed (threshold %.0f%%)." % (args.threshold * 100))
+        return 1
+    print("Throughput check passed (threshold %.0f%%)." % (args.threshold * 100))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,238 @@
+// Benchmark suite for the front end on synthetic inputs of configurable size and shape.
+// Covers lexing (MB/s through Lexer::getNextToken), parsing (statements/s), and building
+// and tearing down the pointer-linked tree and the FlatAst, with the bytes each allocates.
+//
+// Every benchmark takes two arguments: the input shape (see Shape) and its size in bytes.
+// Record a baseline and compare a later build against it with the compare.py script that
+// ships with Google Benchmark:
+//   ./compiler_bench --benchmark_out=baseline.json --benchmark_out_format=json
+//   compare.py benchmarks baseline.json current.json
+//
+// Build: g++ -std=c++17 -O2 bench/compiler_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o compiler_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+namespace
+{
+
+enum Shape
+{
+    LONG_CHAIN,        // one declaration with a very long + / - chain
+    MANY_DECLARATIONS, // many short declarations
+    LONG_IDENTIFIERS,  // declarations with 40+ character names
+    WHITESPACE_HEAVY,  // short declarations padded with long runs of spaces, tabs and newlines
+    LONG_LITERALS,     // declarations adding 16 to 18 digit literals
+    FREQUENT_ERRORS,   // many short declarations, every tenth missing its '=', to time recovery
+    SHAPE_COUNT
+};
+
+const char *shapeName(int shape)
+{
+    switch (shape)
+    {
+    case LONG_CHAIN:
+        return "long_chain";
+    case MANY_DECLARATIONS:
+        return "many_declarations";
+    case LONG_IDENTIFIERS:
+        return "long_identifiers";
+    case LONG_LITERALS:
+        return "long_literals";
+    case FREQUENT_ERRORS:
+        return "frequent_errors";
+    default:
+        return "whitespace_heavy";
+    }
+}
+
+// Generates a program of the given shape, about `bytes` long. Only FREQUENT_ERRORS
+// has syntax errors.
+std::string makeInput(int shape, size_t bytes)
+{
+    std::string code;
+    if (shape == LONG_CHAIN)
+    {
+        code = "int x = 1";
+        for (int i = 1; code.size() < bytes; i++)
+        {
+            code += i % 2 ? " + " : " - ";
+            code += std::to_string(i % 1000);
+        }
+        code += ";\n";
+        return code;
+    }
+    for (int i = 0; code.size() < bytes; i++)
+    {
+        std::string n = std::to_string(i);
+        switch (shape)
+        {
+        case MANY_DECLARATIONS:
+            code += "int v" + n + " = " + n + " + 1 - 2;\n";
+            break;
+        case LONG_IDENTIFIERS:
+            code += "int accumulatedIntermediateResultForStage" + n + "OfPipeline = " + n + ";\n";
+            break;
+        case LONG_LITERALS:
+            code += "int v" + n + " = " + std::to_string(1000000000000000 + i * 7919ll) + " + " +
+                    std::to_string(100000000000000000 - i * 104729ll) + ";\n";
+            break;
+        case FREQUENT_ERRORS:
+            code += "int v" + n + (i % 10 == 9 ? " " : " = ") + n + " + 1 - 2;\n";
+            break;
+        default:
+            code += "int\t\t v" + n + "      =\n\n          " + n + "    +\t\t\t1        ;\n\n\n\n";
+            break;
+        }
+    }
+    return code;
+}
+
+const std::string &input(const benchmark::State &state)
+{
+    static std::string cached[SHAPE_COUNT];
+    static size_t cached_size[SHAPE_COUNT] = {};
+    int shape = static_cast<int>(state.range(0));
+    size_t bytes = static_cast<size_t>(state.range(1));
+    if (cached_size[shape] != bytes)
+    {
+        cached[shape] = makeInput(shape, bytes);
+        cached_size[shape] = bytes;
+    }
+    return cached[shape];
+}
+
+void BM_Lex(benchmark::State &state)
+{
+    const std::string &code = input(state);
+    Interner interner;
+    size_t tokens = 0;
+    for (auto _ : state)
+    {
+        interner.clear();
+        Lexer lexer(code, interner);
+        for (Token token = lexer.getNextToken(); token.type != TokenType::END_OF_FILE; token = lexer.getNextToken())
+        {
+            tokens++;
+        }
+    }
+    state.SetLabel(shapeName(static_cast<int>(state.range(0))));
+    state.SetBytesProcessed(state.iterations() * code.size());
+    state.counters["tokens"] = benchmark::Counter(double(tokens), benchmark::Counter::kAvgIterations);
+}
+
+void BM_Parse(benchmark::State &state)
+{
+    const std::string &code = input(state);
+    Arena arena;
+    Interner interner;
+    Diagnostics diagnostics(code); // collected rather than printed, for FREQUENT_ERRORS
+    std::vector<AstNode *> statements;
+    for (auto _ : state)
+    {
+        arena.reset();
+        interner.clear();
+        diagnostics.clear();
+        statements.clear();
+        Lexer lexer(code, interner);
+        Parser parser(lexer, arena, diagnostics);
+        benchmark::DoNotOptimize(parser.parseProgram(statements));
+    }
+    state.SetLabel(shapeName(static_cast<int>(state.range(0))));
+    state.SetItemsProcessed(state.iterations() * statements.size());
+    state.counters["bytes_allocated"] = double(arena.bytesAllocated());
+}
+
+void BM_ParseFlat(benchmark::State &state)
+{
+    const std::string &code = input(state);
+    Interner interner;
+    Diagnostics diagnostics(code);
+    size_t bytes = 0;
+    size_t statement_count = 0;
+    for (auto _ : state)
+    {
+        interner.clear();
+        diagnostics.clear();
+        FlatAst ast;
+        Lexer lexer(code, interner);
+        FlatParser parser(lexer, ast, diagnostics);
+        std::vector<FlatNodeRef> statements;
+        benchmark::DoNotOptimize(parser.parseProgram(statements));
+        bytes = ast.kinds.capacity() * sizeof(NodeKind) + ast.main_tokens.capacity() * sizeof(uint32_t) +
+                ast.lhs.capacity() * sizeof(uint32_t) + ast.rhs.capacity() * sizeof(uint32_t) +
+                ast.tokens.capacity() * sizeof(Token);
+        statement_count = statements.size();
+    }
+    state.SetLabel(shapeName(static_cast<int>(state.range(0))));
+    state.SetItemsProcessed(state.iterations() * statement_count);
+    state.counters["bytes_allocated"] = double(bytes);
+}
+
+// Build is a parse into a fresh Arena, so it includes acquiring the blocks; teardown is
+// the Arena's destruction. Both are timed by hand so the other half stays out of the figure.
+// Teardown runs a fixed number of iterations: each one needs a full parse that is not
+// timed, so letting the library pick the count from the tiny timed part takes minutes.
+void BM_AstBuild(benchmark::State &state)
+{
+    const std::string &code = input(state);
+    Interner interner;
+    Diagnostics diagnostics(code);
+    size_t capacity = 0;
+    size_t statement_count = 0;
+    for (auto _ : state)
+    {
+        interner.clear();
+        diagnostics.clear();
+        auto start = std::chrono::steady_clock::now();
+        auto arena = std::make_unique<Arena>();
+        Lexer lexer(code, interner);
+        Parser parser(lexer, *arena, diagnostics);
+        std::vector<AstNode *> statements;
+        benchmark::DoNotOptimize(parser.parseProgram(statements));
+        auto end = std::chrono::steady_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+        capacity = arena->capacity();
+        statement_count = statements.size();
+    }
+    state.SetLabel(shapeName(static_cast<int>(state.range(0))));
+    state.SetItemsProcessed(state.iterations() * statement_count);
+    state.counters["bytes_reserved"] = double(capacity);
+}
+
+void BM_AstTeardown(benchmark::State &state)
+{
+    const std::string &code = input(state);
+    Interner interner;
+    Diagnostics diagnostics(code);
+    for (auto _ : state)
+    {
+        interner.clear();
+        diagnostics.clear();
+        auto arena = std::make_unique<Arena>();
+        Lexer lexer(code, interner);
+        Parser parser(lexer, *arena, diagnostics);
+        std::vector<AstNode *> statements;
+        parser.parseProgram(statements);
+        auto start = std::chrono::steady_clock::now();
+        arena = nullptr;
+        auto end = std::chrono::steady_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+    state.SetLabel(shapeName(static_cast<int>(state.range(0))));
+}
+
+const std::vector<std::vector<int64_t>> ARGUMENTS = {
+    {LONG_CHAIN, MANY_DECLARATIONS, LONG_IDENTIFIERS, WHITESPACE_HEAVY, LONG_LITERALS, FREQUENT_ERRORS},
+    {1 << 16, 1 << 22}};
+
+BENCHMARK(BM_Lex)->ArgsProduct(ARGUMENTS)->ArgNames({"shape", "bytes"});
+BENCHMARK(BM_Parse)->ArgsProduct(ARGUMENTS)->ArgNames({"shape", "bytes"});
+BENCHMARK(BM_ParseFlat)->ArgsProduct(ARGUMENTS)->ArgNames({"shape", "bytes"});
+BENCHMARK(BM_AstBuild)->ArgsProduct(ARGUMENTS)->ArgNames({"shape", "bytes"})->UseManualTime();
+BENCHMARK(BM_AstTeardown)->ArgsProduct(ARGUMENTS)->ArgNames({"shape", "bytes"})->UseManualTime()->Iterations(20);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,87 @@
+// Measures eliminateDeadDeclarations on programs where one result reads a fraction of
+// many declarations, and what it saves: bytecode compilation and a VM run of the whole
+// program against the same after elimination. The second argument is the percentage of
+// declarations on the result's dependency chain.
+//
+// Build: g++ -std=c++17 -O2 bench/dead_code_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o dead_code_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+struct Program
+{
+    std::string code;
+    Arena arena;
+    Interner interner;
+    std::vector<AstNode *> statements;
+    std::vector<uint32_t> roots;
+
+    // Every declaration reads the one before it, live or scratch; only the live chain
+    // reaches result.
+    Program(int declarations, int live_percent)
+    {
+        code = "int result = 1;\nint scratch = 1;\n";
+        for (int i = 0; i < declarations; i++)
+        {
+            std::string name = i % 100 < live_percent ? "result" : "scratch";
+            code += "int " + name + " = " + name + " * 3 + " + std::to_string(i % 1000) + " - " + name + ";\n";
+        }
+        Lexer lexer(code, interner);
+        Parser(lexer, arena).parseProgram(statements);
+        roots.push_back(interner.find("result"));
+    }
+};
+
+void BM_Eliminate(benchmark::State &state)
+{
+    Program program(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    std::vector<AstNode *> statements;
+    for (auto _ : state)
+    {
+        statements = program.statements;
+        benchmark::DoNotOptimize(eliminateDeadDeclarations(statements, program.roots, program.interner.size()));
+    }
+    state.SetItemsProcessed(state.iterations() * program.statements.size());
+}
+
+void compileAndRun(benchmark::State &state, bool eliminate)
+{
+    Program program(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    std::vector<AstNode *> statements = program.statements;
+    if (eliminate)
+        eliminateDeadDeclarations(statements, program.roots, program.interner.size());
+    std::vector<int64_t> variables;
+    for (auto _ : state)
+    {
+        BytecodeProgram bytecode = BytecodeCompiler().compile(statements);
+        size_t failed_offset;
+        benchmark::DoNotOptimize(VirtualMachine().run(bytecode, variables, failed_offset));
+    }
+    state.SetItemsProcessed(state.iterations() * program.statements.size());
+}
+
+void BM_CompileAndRun(benchmark::State &state)
+{
+    compileAndRun(state, false);
+}
+
+void BM_EliminateCompileAndRun(benchmark::State &state)
+{
+    compileAndRun(state, true);
+}
+
+const std::vector<std::vector<int64_t>> ARGUMENTS = {{1000000}, {10, 50, 90}};
+
+BENCHMARK(BM_Eliminate)->ArgsProduct(ARGUMENTS)->ArgNames({"declarations", "live"})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompileAndRun)->ArgsProduct(ARGUMENTS)->ArgNames({"declarations", "live"})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EliminateCompileAndRun)
+    ->ArgsProduct(ARGUMENTS)
+    ->ArgNames({"declarations", "live"})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
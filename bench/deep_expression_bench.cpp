@@ -0,0 +1,143 @@
+// Stress benchmark for very deep expressions: parses, folds, walks and frees a single
+// declaration with a million-term expression. Every stage uses loops or explicit stacks,
+// so depth is bounded by heap memory rather than the call stack.
+//
+// printAst output grows quadratically with depth (each line is indented by its depth),
+// so printing is measured on a shallower chain written to a discarding stream.
+//
+// Build: g++ -std=c++17 -O2 bench/deep_expression_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o deep_expression_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+
+namespace
+{
+
+std::string makeChain(int terms)
+{
+    std::string code = "int x = 1";
+    for (int i = 1; i < terms; i++)
+    {
+        code += i % 2 ? " + 2" : " - 1";
+    }
+    code += ";";
+    return code;
+}
+
+// Stream buffer that discards everything written to it.
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+};
+
+size_t countNodes(const AstNode *root)
+{
+    size_t count = 0;
+    std::vector<const AstNode *> stack{root};
+    while (!stack.empty())
+    {
+        const AstNode *node = stack.back();
+        stack.pop_back();
+        count++;
+        if (auto p = nodeAs<VarDeclNode>(node))
+        {
+            stack.push_back(p->expression);
+        }
+        else if (auto p = nodeAs<BinaryOpNode>(node))
+        {
+            stack.push_back(p->left);
+            stack.push_back(p->right);
+        }
+    }
+    return count;
+}
+
+AstNode *parseOne(std::string_view source, Arena &arena, Interner &interner)
+{
+    Lexer lexer(source, interner);
+    Parser parser(lexer, arena);
+    return parser.parse();
+}
+
+void BM_ParseDeepChain(benchmark::State &state)
+{
+    std::string source = makeChain(static_cast<int>(state.range(0)));
+    Arena arena;
+    Interner interner;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(parseOne(source, arena, interner));
+        arena.reset();
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_ParseDeepChain)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+void BM_FoldDeepChain(benchmark::State &state)
+{
+    std::string source = makeChain(static_cast<int>(state.range(0)));
+    Arena arena;
+    Interner interner;
+    std::ostringstream errors;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        arena.reset();
+        AstNode *root = parseOne(source, arena, interner);
+        state.ResumeTiming();
+        foldConstants(root, errors);
+        benchmark::DoNotOptimize(root);
+    }
+}
+BENCHMARK(BM_FoldDeepChain)->Arg(1000000)->Iterations(10)->Unit(benchmark::kMillisecond);
+
+void BM_WalkDeepChain(benchmark::State &state)
+{
+    std::string source = makeChain(static_cast<int>(state.range(0)));
+    Arena arena;
+    Interner interner;
+    AstNode *root = parseOne(source, arena, interner);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(countNodes(root));
+    }
+}
+BENCHMARK(BM_WalkDeepChain)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// Teardown is a single Arena::reset(), independent of tree size and shape.
+void BM_TeardownDeepChain(benchmark::State &state)
+{
+    std::string source = makeChain(static_cast<int>(state.range(0)));
+    Arena arena;
+    Interner interner;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        parseOne(source, arena, interner);
+        state.ResumeTiming();
+        arena.reset();
+    }
+}
+BENCHMARK(BM_TeardownDeepChain)->Arg(1000000)->Iterations(10)->Unit(benchmark::kMicrosecond);
+
+void BM_PrintDeepChain(benchmark::State &state)
+{
+    std::string source = makeChain(static_cast<int>(state.range(0)));
+    Arena arena;
+    Interner interner;
+    AstNode *root = parseOne(source, arena, interner);
+    NullBuffer buffer;
+    std::ostream out(&buffer);
+    for (auto _ : state)
+    {
+        printAst(root, out);
+    }
+}
+BENCHMARK(BM_PrintDeepChain)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,98 @@
+// Compares getting a FlatAst by lexing and parsing the source against getting it from a
+// parse image: viewing an image already in memory (the checks view() makes) and opening
+// an image file, which maps it. Inputs are programs of short declarations.
+//
+// Build: g++ -std=c++17 -O2 bench/image_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o image_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <filesystem>
+
+namespace
+{
+
+std::string makeProgram(size_t bytes)
+{
+    std::string code;
+    for (int i = 0; code.size() < bytes; i++)
+    {
+        std::string n = std::to_string(i);
+        code += "int v" + n + " = v" + std::to_string(i / 2) + " * " + n + " + 1 - 2;\n";
+    }
+    return code;
+}
+
+std::string makeImage(const std::string &code)
+{
+    Interner interner;
+    FlatAst ast;
+    std::vector<FlatNodeRef> statements;
+    Lexer lexer(code, interner);
+    FlatParser parser(lexer, ast);
+    parser.parseProgram(statements);
+    std::vector<Token> tokens;
+    Lexer stream(code, interner);
+    for (Token token = stream.getNextToken(); token.type != TokenType::END_OF_FILE; token = stream.getNextToken())
+    {
+        tokens.push_back(token);
+    }
+    std::string image;
+    buildParseImage(tokens, ast, statements, interner, image);
+    return image;
+}
+
+void BM_LexAndParse(benchmark::State &state)
+{
+    std::string code = makeProgram(static_cast<size_t>(state.range(0)));
+    Interner interner;
+    FlatAst ast;
+    std::vector<FlatNodeRef> statements;
+    for (auto _ : state)
+    {
+        interner.clear();
+        ast.clear();
+        statements.clear();
+        Lexer lexer(code, interner);
+        FlatParser parser(lexer, ast);
+        benchmark::DoNotOptimize(parser.parseProgram(statements));
+    }
+    state.SetBytesProcessed(state.iterations() * code.size());
+}
+BENCHMARK(BM_LexAndParse)->Arg(1 << 16)->Arg(1 << 22);
+
+void BM_ViewImage(benchmark::State &state)
+{
+    std::string code = makeProgram(static_cast<size_t>(state.range(0)));
+    std::string image = makeImage(code);
+    for (auto _ : state)
+    {
+        ParseImage view;
+        benchmark::DoNotOptimize(view.view(image));
+    }
+    state.SetBytesProcessed(state.iterations() * code.size());
+    state.counters["image_bytes"] = double(image.size());
+}
+BENCHMARK(BM_ViewImage)->Arg(1 << 16)->Arg(1 << 22);
+
+void BM_OpenImage(benchmark::State &state)
+{
+    std::string code = makeProgram(static_cast<size_t>(state.range(0)));
+    std::string image = makeImage(code);
+    std::string path = (std::filesystem::temp_directory_path() / "mini_compiler_image_bench.img").string();
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    std::fwrite(image.data(), 1, image.size(), file);
+    std::fclose(file);
+    for (auto _ : state)
+    {
+        ParseImage view;
+        benchmark::DoNotOptimize(view.open(path));
+    }
+    std::remove(path.c_str());
+    state.SetBytesProcessed(state.iterations() * code.size());
+}
+BENCHMARK(BM_OpenImage)->Arg(1 << 16)->Arg(1 << 22);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,75 @@
+// Measures the latency of a one-character edit with IncrementalParser against parsing
+// the whole edited file again, for a range of file sizes. The incremental cost should
+// stay flat as the file grows.
+//
+// Build: g++ -std=c++17 -O2 bench/incremental_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o incremental_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+constexpr int TERMS_PER_DECLARATION = 20;
+
+std::string makeProgram(int declarations)
+{
+    std::string code;
+    for (int i = 0; i < declarations; i++)
+    {
+        code += "int v" + std::to_string(i) + " = 1";
+        for (int j = 1; j < TERMS_PER_DECLARATION; j++)
+        {
+            code += j % 2 ? " + " : " - ";
+            code += std::to_string(j);
+        }
+        code += ";\n";
+    }
+    return code;
+}
+
+// Flips the leading literal of the middle declaration between 1 and 2.
+size_t editOffset(const std::string &code)
+{
+    return code.find(" = ", code.size() / 2) + 3;
+}
+
+void BM_FullReparse(benchmark::State &state)
+{
+    std::string code = makeProgram(static_cast<int>(state.range(0)));
+    size_t offset = editOffset(code);
+    Arena arena;
+    Interner interner;
+    std::vector<AstNode *> statements;
+    for (auto _ : state)
+    {
+        code[offset] = code[offset] == '1' ? '2' : '1';
+        arena.reset();
+        interner.clear();
+        statements.clear();
+        Lexer lexer(code, interner);
+        Parser parser(lexer, arena);
+        benchmark::DoNotOptimize(parser.parseProgram(statements));
+    }
+}
+BENCHMARK(BM_FullReparse)->Range(1 << 10, 1 << 16)->Unit(benchmark::kMicrosecond);
+
+void BM_IncrementalEdit(benchmark::State &state)
+{
+    std::string code = makeProgram(static_cast<int>(state.range(0)));
+    size_t offset = editOffset(code);
+    Interner interner;
+    IncrementalParser document(interner);
+    document.open(code);
+    bool flip = false;
+    for (auto _ : state)
+    {
+        flip = !flip;
+        benchmark::DoNotOptimize(document.edit(offset, 1, flip ? "2" : "1"));
+    }
+}
+BENCHMARK(BM_IncrementalEdit)->Range(1 << 10, 1 << 16)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
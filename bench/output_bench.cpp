@@ -0,0 +1,112 @@
+// Measures dumping a parsed program: the indented text of printAst and printFlatAst and
+// the JSON lines of printAstJson, on many short declarations and on one long chain,
+// whose tree is deep enough for the indentation to dominate. Output goes to an
+// ostringstream that is emptied between iterations.
+//
+// Build: g++ -std=c++17 -O2 bench/output_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o output_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+
+namespace
+{
+
+enum Shape
+{
+    MANY_DECLARATIONS, // int vN = N + 1 * vM; repeated
+    LONG_CHAIN         // int x = 1 + 2 - 3 ..., a left-leaning tree as deep as it is long
+};
+
+std::string makeProgram(int shape, int count)
+{
+    std::string code;
+    if (shape == LONG_CHAIN)
+    {
+        code = "int x = 1";
+        for (int i = 1; i < count; i++)
+        {
+            code += i % 2 ? " + " : " - ";
+            code += std::to_string(i % 1000);
+        }
+        return code + ";\n";
+    }
+    for (int i = 0; i < count; i++)
+    {
+        std::string n = std::to_string(i);
+        code += "int v" + n + " = " + n + " + 1 * v" + std::to_string(i / 2) + ";\n";
+    }
+    return code;
+}
+
+struct Parsed
+{
+    std::string code;
+    Arena arena;
+    Interner interner;
+    std::vector<AstNode *> statements;
+    FlatAst ast;
+    std::vector<FlatNodeRef> flat_statements;
+
+    explicit Parsed(const benchmark::State &state)
+        : code(makeProgram(static_cast<int>(state.range(0)), static_cast<int>(state.range(1))))
+    {
+        Lexer lexer(code, interner);
+        Parser(lexer, arena).parseProgram(statements);
+        Lexer flat_lexer(code, interner);
+        FlatParser(flat_lexer, ast).parseProgram(flat_statements);
+    }
+};
+
+void BM_PrintAst(benchmark::State &state)
+{
+    Parsed parsed(state);
+    std::ostringstream out;
+    for (auto _ : state)
+    {
+        out.str("");
+        for (const AstNode *statement : parsed.statements)
+        {
+            printAst(statement, out);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * out.str().size());
+}
+
+void BM_PrintFlatAst(benchmark::State &state)
+{
+    Parsed parsed(state);
+    std::ostringstream out;
+    for (auto _ : state)
+    {
+        out.str("");
+        for (FlatNodeRef statement : parsed.flat_statements)
+        {
+            printFlatAst(parsed.ast, statement.index, out);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * out.str().size());
+}
+
+void BM_PrintAstJson(benchmark::State &state)
+{
+    Parsed parsed(state);
+    std::ostringstream out;
+    for (auto _ : state)
+    {
+        out.str("");
+        printAstJson(parsed.statements, out);
+    }
+    state.SetBytesProcessed(state.iterations() * out.str().size());
+}
+
+const std::vector<std::vector<int64_t>> ARGUMENTS = {{MANY_DECLARATIONS}, {100000}};
+const std::vector<std::vector<int64_t>> CHAIN_ARGUMENTS = {{LONG_CHAIN}, {2000}};
+
+BENCHMARK(BM_PrintAst)->ArgsProduct(ARGUMENTS)->ArgsProduct(CHAIN_ARGUMENTS)->ArgNames({"shape", "count"});
+BENCHMARK(BM_PrintFlatAst)->ArgsProduct(ARGUMENTS)->ArgsProduct(CHAIN_ARGUMENTS)->ArgNames({"shape", "count"});
+BENCHMARK(BM_PrintAstJson)->ArgsProduct(ARGUMENTS)->ArgsProduct(CHAIN_ARGUMENTS)->ArgNames({"shape", "count"});
+
+} // namespace
+
+BENCHMARK_MAIN();
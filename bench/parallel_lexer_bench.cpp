@@ -0,0 +1,64 @@
+// Measures lexing a large input into a token vector with the serial Lexer and with
+// lexParallel at several thread counts. The input size is the second argument; raise
+// it to gigabytes to check scaling on a larger machine (tokens take about 8 times the
+// input's size in memory).
+//
+// Build: g++ -std=c++17 -O2 bench/parallel_lexer_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o parallel_lexer_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+// Declarations of a thousand distinct names, so chunks share most of their symbols.
+std::string makeInput(size_t bytes)
+{
+    std::string code;
+    for (int i = 0; code.size() < bytes; i++)
+    {
+        std::string n = std::to_string(i % 1000);
+        code += "int value" + n + " = (value" + std::to_string(i % 997) + " + " + std::to_string(i) + ") * 3;\n";
+    }
+    return code;
+}
+
+void BM_LexSerial(benchmark::State &state)
+{
+    std::string code = makeInput(static_cast<size_t>(state.range(1)));
+    std::vector<Token> tokens;
+    for (auto _ : state)
+    {
+        Interner interner;
+        tokens.clear();
+        Lexer lexer(code, interner);
+        for (Token token = lexer.getNextToken(); token.type != TokenType::END_OF_FILE; token = lexer.getNextToken())
+        {
+            tokens.push_back(token);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * code.size());
+}
+BENCHMARK(BM_LexSerial)->Args({1, 64 << 20})->ArgNames({"threads", "bytes"})->Unit(benchmark::kMillisecond);
+
+void BM_LexParallel(benchmark::State &state)
+{
+    std::string code = makeInput(static_cast<size_t>(state.range(1)));
+    std::vector<Token> tokens;
+    for (auto _ : state)
+    {
+        Interner interner;
+        tokens.clear();
+        lexParallel(code, interner, tokens, static_cast<size_t>(state.range(0)));
+    }
+    state.SetBytesProcessed(state.iterations() * code.size());
+}
+BENCHMARK(BM_LexParallel)
+    ->ArgsProduct({{1, 2, 4, 8}, {64 << 20}})
+    ->ArgNames({"threads", "bytes"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,123 @@
+// Measures the precedence-climbing expression parser on deep mixed-operator expressions:
+// a flat chain that alternates precedence levels, left-nested and right-nested
+// parentheses, and a chain that mixes variables with literals. Each case parses one
+// declaration with a million operands.
+//
+// Build: g++ -std=c++17 -O2 bench/precedence_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o precedence_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+enum Shape
+{
+    MIXED_CHAIN,  // 1 * 2 - 3 / 4 + 5 ..., every other operator binds tighter
+    LEFT_NESTED,  // ((((1 * 2) - 3) / 4) + 5 ...), closing a parenthesis per operand
+    RIGHT_NESTED, // 1 * (2 - (3 / (4 + (5 ...)))), keeping every operator pending
+    VARIABLES     // 1 * a - 3 / b + 5 ..., literals and identifiers alternating
+};
+
+const char OPERATORS[] = {'+', '*', '-', '/'};
+
+// Generates a declaration of x with the given number of operands, after declarations
+// of the variables it reads.
+std::string makeExpression(int shape, int operands)
+{
+    std::string code = "int a = 1; int b = 2; int x = ";
+    if (shape == LEFT_NESTED)
+        code.append(operands - 1, '(');
+    for (int i = 0; i < operands; i++)
+    {
+        if (i > 0)
+        {
+            code += ' ';
+            code += OPERATORS[i % 4];
+            code += ' ';
+            if (shape == RIGHT_NESTED && i < operands - 1)
+                code += '(';
+        }
+        if (shape == VARIABLES && i % 2)
+            code += i % 4 == 1 ? "a" : "b";
+        else
+            code += std::to_string(i % 9 + 1);
+        if (shape == LEFT_NESTED && i > 0)
+            code += ')';
+    }
+    if (shape == RIGHT_NESTED)
+        code.append(operands > 2 ? operands - 2 : 0, ')');
+    code += ";";
+    return code;
+}
+
+void BM_ParseExpression(benchmark::State &state)
+{
+    std::string source = makeExpression(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    Arena arena;
+    Interner interner;
+    std::vector<AstNode *> statements;
+    for (auto _ : state)
+    {
+        Lexer lexer(source, interner);
+        Parser parser(lexer, arena);
+        statements.clear();
+        benchmark::DoNotOptimize(parser.parseProgram(statements));
+        arena.reset();
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_ParseExpression)
+    ->ArgsProduct({{MIXED_CHAIN, LEFT_NESTED, RIGHT_NESTED, VARIABLES}, {1000000}})
+    ->ArgNames({"shape", "operands"})
+    ->Unit(benchmark::kMillisecond);
+
+// The same inputs through the FlatAst back end, which shares the parsing loop.
+void BM_ParseExpressionFlat(benchmark::State &state)
+{
+    std::string source = makeExpression(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    Interner interner;
+    FlatAst ast;
+    std::vector<FlatNodeRef> statements;
+    for (auto _ : state)
+    {
+        Lexer lexer(source, interner);
+        FlatParser parser(lexer, ast);
+        statements.clear();
+        benchmark::DoNotOptimize(parser.parseProgram(statements));
+        ast.clear();
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_ParseExpressionFlat)
+    ->ArgsProduct({{MIXED_CHAIN, LEFT_NESTED, RIGHT_NESTED, VARIABLES}, {1000000}})
+    ->ArgNames({"shape", "operands"})
+    ->Unit(benchmark::kMillisecond);
+
+// Compiles and runs the variable chain, where every other operand is a LOAD.
+void BM_RunVariables(benchmark::State &state)
+{
+    std::string source = makeExpression(VARIABLES, static_cast<int>(state.range(0)));
+    Arena arena;
+    Interner interner;
+    Lexer lexer(source, interner);
+    Parser parser(lexer, arena);
+    std::vector<AstNode *> statements;
+    parser.parseProgram(statements);
+    BytecodeProgram program = BytecodeCompiler().compile(statements);
+    VirtualMachine vm;
+    std::vector<int64_t> variables;
+    size_t failed;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(vm.run(program, variables, failed));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RunVariables)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,83 @@
+// Measures SemanticAnalyzer on programs of many declarations that each read two
+// earlier ones, against the same resolution done with a std::unordered_map scope
+// table keyed by symbol ID, the usual first implementation.
+//
+// Build: g++ -std=c++17 -O2 bench/semantic_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o semantic_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+#include <unordered_map>
+
+namespace
+{
+
+struct Program
+{
+    std::string code;
+    Arena arena;
+    Interner interner;
+    std::vector<AstNode *> statements;
+
+    explicit Program(int declarations)
+    {
+        code = "int v0 = 1;\n";
+        for (int i = 1; i < declarations; i++)
+        {
+            code += "int v" + std::to_string(i) + " = v" + std::to_string(i / 2) + " + v" + std::to_string(i - 1) +
+                    " * 3;\n";
+        }
+        Lexer lexer(code, interner);
+        Parser(lexer, arena).parseProgram(statements);
+    }
+};
+
+void BM_Analyze(benchmark::State &state)
+{
+    Program program(static_cast<int>(state.range(0)));
+    SemanticAnalyzer analyzer;
+    Diagnostics diagnostics(program.code);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(analyzer.analyze(program.statements, program.interner.size(), diagnostics));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Analyze)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+void BM_AnalyzeUnorderedMap(benchmark::State &state)
+{
+    Program program(static_cast<int>(state.range(0)));
+    std::vector<const AstNode *> stack;
+    for (auto _ : state)
+    {
+        std::unordered_map<uint32_t, uint32_t> scope;
+        size_t problems = 0;
+        for (size_t index = 0; index < program.statements.size(); index++)
+        {
+            auto decl = static_cast<const VarDeclNode *>(program.statements[index]);
+            stack.assign(1, decl->expression);
+            while (!stack.empty())
+            {
+                const AstNode *node = stack.back();
+                stack.pop_back();
+                if (node->kind == NodeKind::VARIABLE)
+                {
+                    problems += !scope.count(static_cast<const VariableNode *>(node)->identifier.symbol);
+                }
+                else if (node->kind == NodeKind::BINARY_OP)
+                {
+                    stack.push_back(static_cast<const BinaryOpNode *>(node)->right);
+                    stack.push_back(static_cast<const BinaryOpNode *>(node)->left);
+                }
+            }
+            problems += !scope.emplace(decl->identifier.symbol, static_cast<uint32_t>(index)).second;
+        }
+        benchmark::DoNotOptimize(problems);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnalyzeUnorderedMap)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
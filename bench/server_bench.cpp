@@ -0,0 +1,143 @@
+// Measures CompileServer round trips: each benchmark thread is a client that sends a
+// small program over a Unix socket and waits for its response before the next, against
+// compiling the same program in process with compileSource, the floor for any server.
+// The server's p50 and p99 latencies are reported as counters, in microseconds.
+//
+// Build: g++ -std=c++17 -O2 bench/server_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o server_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+
+const char *SOCKET_PATH = "/tmp/mini_compiler_server_bench.sock";
+const std::string PROGRAM = "int a = 6;\nint b = a * 7 + 3;\nint c = (b - a) / 2;\n";
+
+bool sendAll(int fd, std::string_view data)
+{
+    while (!data.empty())
+    {
+        ssize_t sent = send(fd, data.data(), data.size(), 0);
+        if (sent <= 0)
+            return false;
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+// Reads one response and returns its total size, or 0 if the connection broke.
+size_t receiveResponse(int fd, std::string &buffer)
+{
+    char chunk[4096];
+    while (true)
+    {
+        size_t newline = buffer.find('\n');
+        if (newline != std::string::npos)
+        {
+            std::istringstream header(buffer.substr(0, newline));
+            std::string status;
+            size_t output = 0;
+            size_t errors = 0;
+            header >> status >> output >> errors;
+            size_t total = newline + 1 + output + errors;
+            if (buffer.size() >= total)
+            {
+                buffer.erase(0, total);
+                return total;
+            }
+        }
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0)
+            return 0;
+        buffer.append(chunk, static_cast<size_t>(received));
+    }
+}
+
+int connectToServer()
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, SOCKET_PATH);
+    connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    return fd;
+}
+
+// Set up by the first client thread; the benchmark loop starts only once every thread
+// has reached it.
+struct Server
+{
+    WorkStealingPool pool;
+    CompileServer server;
+    std::thread serving;
+
+    explicit Server(const DriverOptions &options) : server(options, pool) {}
+};
+std::unique_ptr<Server> running;
+
+void BM_ServerRoundTrip(benchmark::State &state)
+{
+    if (state.thread_index() == 0)
+    {
+        DriverOptions options;
+        options.run = true;
+        running = std::make_unique<Server>(options);
+        if (!running->server.listen(SOCKET_PATH))
+            state.SkipWithError("cannot listen");
+        else
+            running->serving = std::thread([] { running->server.serve(); });
+    }
+    std::string request = std::to_string(PROGRAM.size()) + "\n" + PROGRAM;
+    std::string buffer;
+    int fd = -1;
+    for (auto _ : state)
+    {
+        if (fd < 0)
+            fd = connectToServer();
+        sendAll(fd, request);
+        if (receiveResponse(fd, buffer) == 0)
+            state.SkipWithError("connection broke");
+    }
+    close(fd);
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0)
+    {
+        running->server.stop();
+        if (running->serving.joinable())
+            running->serving.join();
+        const ServerStats &stats = running->server.stats();
+        state.counters["p50_us"] = stats.latency.percentile(0.5) / 1e3;
+        state.counters["p99_us"] = stats.latency.percentile(0.99) / 1e3;
+        state.counters["per_batch"] = stats.batches ? static_cast<double>(stats.requests) / stats.batches : 0;
+        running.reset();
+    }
+}
+BENCHMARK(BM_ServerRoundTrip)->Threads(1)->Threads(4)->Threads(16)->UseRealTime();
+
+void BM_CompileInProcess(benchmark::State &state)
+{
+    DriverOptions options;
+    options.run = true;
+    CompilerContext context;
+    for (auto _ : state)
+    {
+        std::ostringstream out;
+        std::ostringstream errors;
+        benchmark::DoNotOptimize(compileSource(PROGRAM, options, context, out, errors));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CompileInProcess);
+
+} // namespace
+
+BENCHMARK_MAIN();
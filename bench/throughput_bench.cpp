@@ -0,0 +1,89 @@
+// Measures lexing and parsing throughput on the fixed inputs in bench/corpus, one
+// benchmark per phase and file, so a regression shows which input shape it hits.
+// bench/check_throughput.py runs this and compares the bytes_per_second of each
+// benchmark against the baseline stored in bench/throughput_baseline.json.
+//
+// The corpus directory is the first argument after the benchmark flags, by default
+// bench/corpus from the repository root. Its files are never regenerated, so results
+// stay comparable from commit to commit.
+//
+// Build: g++ -std=c++17 -O2 bench/throughput_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o throughput_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <memory>
+
+namespace
+{
+
+void BM_Lex(benchmark::State &state, std::string_view code)
+{
+    for (auto _ : state)
+    {
+        Interner interner;
+        Lexer lexer(code, interner);
+        while (lexer.getNextToken().type != TokenType::END_OF_FILE)
+        {
+        }
+        benchmark::DoNotOptimize(interner.size());
+    }
+    state.SetBytesProcessed(state.iterations() * code.size());
+}
+
+// Lexing included, as the parser pulls its tokens from the lexer.
+void BM_Parse(benchmark::State &state, std::string_view code)
+{
+    Arena arena;
+    std::vector<AstNode *> statements;
+    for (auto _ : state)
+    {
+        Interner interner;
+        arena.reset();
+        statements.clear();
+        Lexer lexer(code, interner);
+        benchmark::DoNotOptimize(Parser(lexer, arena).parseProgram(statements));
+    }
+    state.SetBytesProcessed(state.iterations() * code.size());
+}
+
+void BM_ParseFlat(benchmark::State &state, std::string_view code)
+{
+    FlatAst ast;
+    std::vector<FlatNodeRef> statements;
+    for (auto _ : state)
+    {
+        Interner interner;
+        ast.clear();
+        statements.clear();
+        Lexer lexer(code, interner);
+        benchmark::DoNotOptimize(FlatParser(lexer, ast).parseProgram(statements));
+    }
+    state.SetBytesProcessed(state.iterations() * code.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    benchmark::Initialize(&argc, argv);
+    std::vector<std::string> paths{argc > 1 ? argv[1] : "bench/corpus"};
+    if (!expandInputPaths(paths))
+        return 1;
+    // The files outlive the benchmarks, which view their text.
+    std::vector<std::unique_ptr<SourceFile>> files;
+    for (const std::string &path : paths)
+    {
+        files.push_back(std::make_unique<SourceFile>());
+        if (!files.back()->open(path))
+            return 1;
+        std::string_view code = files.back()->text();
+        std::string name = std::filesystem::path(path).stem().string();
+        benchmark::RegisterBenchmark(("BM_Lex/" + name).c_str(), BM_Lex, code);
+        benchmark::RegisterBenchmark(("BM_Parse/" + name).c_str(), BM_Parse, code);
+        benchmark::RegisterBenchmark(("BM_ParseFlat/" + name).c_str(), BM_ParseFlat, code);
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,177 @@
+// Compares executing a program with the bytecode VirtualMachine and the native JitProgram
+// against walking the AST with evaluateProgram. Compilation is measured separately; the
+// workload is many declarations with medium-length expressions.
+//
+// Build: g++ -std=c++17 -O2 bench/vm_bench.cpp compiler/*.cpp -lbenchmark -lpthread -o vm_bench
+#include "../compiler/compiler.h"
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+constexpr int DECLARATION_COUNT = 10000;
+constexpr int TERMS_PER_DECLARATION = 50;
+
+std::string makeProgram()
+{
+    std::string code;
+    for (int i = 0; i < DECLARATION_COUNT; i++)
+    {
+        code += "int v" + std::to_string(i) + " = " + std::to_string(i);
+        for (int j = 1; j < TERMS_PER_DECLARATION; j++)
+        {
+            code += j % 2 ? " + " : " - ";
+            code += std::to_string(j * 7 % 101);
+        }
+        code += ";\n";
+    }
+    return code;
+}
+
+struct Fixture
+{
+    std::string source = makeProgram();
+    Arena arena;
+    Interner interner;
+    std::vector<AstNode *> statements;
+    BytecodeProgram program;
+    JitProgram jit;
+
+    Fixture()
+    {
+        Lexer lexer(source, interner);
+        Parser parser(lexer, arena);
+        parser.parseProgram(statements);
+        program = BytecodeCompiler().compile(statements);
+        jit.compile(statements);
+    }
+};
+
+Fixture &fixture()
+{
+    static Fixture instance;
+    return instance;
+}
+
+constexpr int64_t OPERATIONS = int64_t(DECLARATION_COUNT) * (TERMS_PER_DECLARATION - 1);
+
+void BM_EvaluateAst(benchmark::State &state)
+{
+    Fixture &f = fixture();
+    std::vector<int64_t> variables;
+    size_t failed;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(evaluateProgram(f.statements, variables, failed));
+    }
+    state.SetItemsProcessed(state.iterations() * OPERATIONS);
+}
+BENCHMARK(BM_EvaluateAst)->Unit(benchmark::kMillisecond);
+
+void BM_RunBytecode(benchmark::State &state)
+{
+    Fixture &f = fixture();
+    VirtualMachine vm;
+    std::vector<int64_t> variables;
+    size_t failed;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(vm.run(f.program, variables, failed));
+    }
+    state.SetItemsProcessed(state.iterations() * OPERATIONS);
+}
+BENCHMARK(BM_RunBytecode)->Unit(benchmark::kMillisecond);
+
+// Falls back to the tree evaluator where the JIT is unsupported.
+void BM_RunJit(benchmark::State &state)
+{
+    Fixture &f = fixture();
+    std::vector<int64_t> variables;
+    size_t failed;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(f.jit.run(variables, failed));
+    }
+    state.SetItemsProcessed(state.iterations() * OPERATIONS);
+    state.counters["native"] = static_cast<double>(f.jit.nativeCount());
+}
+BENCHMARK(BM_RunJit)->Unit(benchmark::kMillisecond);
+
+// One declaration evaluated over and over, the case the JIT is meant for: its code stays
+// hot in the instruction cache, so only dispatch overhead separates the back ends.
+struct HotFixture
+{
+    std::string source = "int hot = 1 + 2 - 3 + 4 - 5 + 6 - 7 + 8 - 9 + 10 - 11 + 12 - 13 + 14 - 15 + 16;";
+    Arena arena;
+    Interner interner;
+    std::vector<AstNode *> statements;
+    BytecodeProgram program;
+    JitProgram jit;
+
+    HotFixture()
+    {
+        Lexer lexer(source, interner);
+        Parser parser(lexer, arena);
+        parser.parseProgram(statements);
+        program = BytecodeCompiler().compile(statements);
+        jit.compile(statements);
+    }
+};
+
+HotFixture &hotFixture()
+{
+    static HotFixture instance;
+    return instance;
+}
+
+void BM_HotRunBytecode(benchmark::State &state)
+{
+    HotFixture &f = hotFixture();
+    VirtualMachine vm;
+    std::vector<int64_t> variables;
+    size_t failed;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(vm.run(f.program, variables, failed));
+    }
+}
+BENCHMARK(BM_HotRunBytecode);
+
+void BM_HotRunJit(benchmark::State &state)
+{
+    HotFixture &f = hotFixture();
+    std::vector<int64_t> variables;
+    size_t failed;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(f.jit.run(variables, failed));
+    }
+}
+BENCHMARK(BM_HotRunJit);
+
+void BM_CompileJit(benchmark::State &state)
+{
+    Fixture &f = fixture();
+    JitProgram jit;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(jit.compile(f.statements));
+    }
+}
+BENCHMARK(BM_CompileJit)->Unit(benchmark::kMillisecond);
+
+void BM_CompileBytecode(benchmark::State &state)
+{
+    Fixture &f = fixture();
+    BytecodeCompiler compiler;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(compiler.compile(f.statements));
+    }
+}
+BENCHMARK(BM_CompileBytecode)->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+#ifndef MINI_COMPILER_ARENA_H
+#define MINI_COMPILER_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Bump allocator that owns every AST node of one compilation unit. Nodes are carved
+// out of large blocks so they sit next to each other in memory, and the whole tree is
+// released at once by reset() or the destructor. Destructors of arena objects are
+// never run, so nodes may only hold trivially destructible members.
+class Arena
+{
+public:
+    explicit Arena(size_t block_size = 64 * 1024) : block_size(block_size) {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // Alignments up to alignof(std::max_align_t) are supported.
+    void *allocate(size_t size, size_t alignment)
+    {
+        size_t offset = (used + alignment - 1) & ~(alignment - 1);
+        if (blocks.empty() || offset + size > blocks[current].size)
+        {
+            nextBlock(size);
+            offset = 0;
+        }
+        used = offset + size;
+        allocated += size;
+        allocation_count++;
+        return blocks[current].data.get() + offset;
+    }
+
+    template <typename T, typename... Args>
+    T *make(Args &&...args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Frees every object in O(1). The blocks are kept and reused by later allocations.
+    void reset()
+    {
+        current = 0;
+        used = 0;
+        allocated = 0;
+        allocation_count = 0;
+    }
+
+    // Bytes handed out by allocate() and the number of calls, since construction or the
+    // last reset().
+    size_t bytesAllocated() const { return allocated; }
+    size_t allocations() const { return allocation_count; }
+
+    // Bytes of all blocks, the memory the arena holds from the system.
+    size_t capacity() const
+    {
+        size_t total = 0;
+        for (const Block &block : blocks)
+        {
+            total += block.size;
+        }
+        return total;
+    }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    size_t block_size;
+    std::vector<Block> blocks;
+    size_t current = 0; // index of the block being filled
+    size_t used = 0;    // bytes used in the current block
+    size_t allocated = 0;
+    size_t allocation_count = 0;
+
+    void nextBlock(size_t min_size)
+    {
+        size_t next = blocks.empty() ? 0 : current + 1;
+        if (next == blocks.size() || blocks[next].size < min_size)
+        {
+            size_t size = std::max(block_size, min_size);
+            blocks.insert(blocks.begin() + next, Block{std::unique_ptr<char[]>(new char[size]), size});
+        }
+        current = next;
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef MINI_COMPILER_ARITH_H
+#define MINI_COMPILER_ARITH_H
+
+#include "token.h"
+
+#include <cstdint>
+
+// Outcome of evaluating one arithmetic operator on 64-bit integers.
+enum class ArithStatus
+{
+    OK,
+    INTEGER_OVERFLOW,
+    DIVISION_BY_ZERO
+};
+
+// Checked 64-bit integer operations. Each returns OK and stores the result, or reports
+// why the operation has no value.
+inline ArithStatus checkedAdd(int64_t a, int64_t b, int64_t &result)
+{
+    if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b))
+        return ArithStatus::INTEGER_OVERFLOW;
+    result = a + b;
+    return ArithStatus::OK;
+}
+
+inline ArithStatus checkedSubtract(int64_t a, int64_t b, int64_t &result)
+{
+    if ((b < 0 && a > INT64_MAX + b) || (b > 0 && a < INT64_MIN + b))
+        return ArithStatus::INTEGER_OVERFLOW;
+    result = a - b;
+    return ArithStatus::OK;
+}
+
+inline ArithStatus checkedMultiply(int64_t a, int64_t b, int64_t &result)
+{
+    // Multiply as unsigned so the wrapped product can be checked without undefined behavior.
+    int64_t product = static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+    if ((a == -1 && b == INT64_MIN) || (b == -1 && a == INT64_MIN) || (a != 0 && product / a != b))
+        return ArithStatus::INTEGER_OVERFLOW;
+    result = product;
+    return ArithStatus::OK;
+}
+
+inline ArithStatus checkedDivide(int64_t a, int64_t b, int64_t &result)
+{
+    if (b == 0)
+        return ArithStatus::DIVISION_BY_ZERO;
+    if (a == INT64_MIN && b == -1)
+        return ArithStatus::INTEGER_OVERFLOW;
+    result = a / b;
+    return ArithStatus::OK;
+}
+
+// Applies a binary operator token to two values. Together with the checked operations
+// above this is the single definition of the language's integer semantics, shared by
+// every pass that evaluates expressions.
+inline ArithStatus applyBinaryOp(TokenType op, int64_t a, int64_t b, int64_t &result)
+{
+    switch (op)
+    {
+    case TokenType::OPERATOR_PLUS:
+        return checkedAdd(a, b, result);
+    case TokenType::OPERATOR_MINUS:
+        return checkedSubtract(a, b, result);
+    case TokenType::OPERATOR_MULTIPLY:
+        return checkedMultiply(a, b, result);
+    case TokenType::OPERATOR_DIVIDE:
+        return checkedDivide(a, b, result);
+    default:
+        return ArithStatus::INTEGER_OVERFLOW;
+    }
+}
+
+// Human-readable description of a failed ArithStatus.
+inline const char *arithStatusMessage(ArithStatus status)
+{
+    return status == ArithStatus::DIVISION_BY_ZERO ? "Division by zero" : "Integer overflow";
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef MINI_COMPILER_AST_H
+#define MINI_COMPILER_AST_H
+
+#include "arena.h"
+#include "token.h"
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Identifies the concrete type of an AstNode so passes can dispatch with a switch
+// instead of RTTI.
+enum class NodeKind : uint8_t
+{
+    NUMBER,
+    VARIABLE,
+    BINARY_OP,
+    VAR_DECL
+};
+
+// Base struct for all Abstract Syntax Tree nodes. Nodes live in an Arena.
+struct AstNode
+{
+    NodeKind kind;
+
+protected:
+    explicit AstNode(NodeKind k) : kind(k) {}
+};
+
+// Represents a number literal in the code.
+struct NumberNode : public AstNode
+{
+    static constexpr NodeKind KIND = NodeKind::NUMBER;
+    Token token;
+    int64_t value;
+    NumberNode(Token t, int64_t v) : AstNode(KIND), token(t), value(v) {}
+};
+
+// Represents a use of a variable; its value is that of the latest declaration
+// before it, or 0 if there is none.
+struct VariableNode : public AstNode
+{
+    static constexpr NodeKind KIND = NodeKind::VARIABLE;
+    Token identifier;
+    explicit VariableNode(Token id) : AstNode(KIND), identifier(id) {}
+};
+
+// Represents a binary operation (e.g., 10 + 20).
+struct BinaryOpNode : public AstNode
+{
+    static constexpr NodeKind KIND = NodeKind::BINARY_OP;
+    AstNode *left;
+    Token op;
+    AstNode *right;
+    BinaryOpNode(AstNode *l, Token o, AstNode *r)
+        : AstNode(KIND), left(l), op(o), right(r) {}
+};
+
+// Represents a variable declaration statement.
+struct VarDeclNode : public AstNode
+{
+    static constexpr NodeKind KIND = NodeKind::VAR_DECL;
+    Token type;
+    Token identifier;
+    AstNode *expression;
+    VarDeclNode(Token t, Token id, AstNode *expr)
+        : AstNode(KIND), type(t), identifier(id), expression(expr) {}
+};
+
+static_assert(std::is_trivially_destructible<NumberNode>::value &&
+                  std::is_trivially_destructible<VariableNode>::value &&
+                  std::is_trivially_destructible<BinaryOpNode>::value &&
+                  std::is_trivially_destructible<VarDeclNode>::value,
+              "Arena never runs node destructors");
+
+// Checked downcast: returns the node as T if its kind matches, otherwise nullptr.
+template <typename T>
+const T *nodeAs(const AstNode *node)
+{
+    return node && node->kind == T::KIND ? static_cast<const T *>(node) : nullptr;
+}
+
+template <typename T>
+T *nodeAs(AstNode *node)
+{
+    return node && node->kind == T::KIND ? static_cast<T *>(node) : nullptr;
+}
+
+// Compact, pointer-free AST for large inputs. Nodes are stored struct-of-arrays and
+// refer to their children and tokens by 32-bit index. Children are always added before
+// their parents, so passes that only need bottom-up order can walk the arrays linearly.
+// The per-node fields mean, by kind:
+//   NUMBER     main_token = literal,    lhs/rhs = low/high 32 bits of the value
+//   VARIABLE   main_token = identifier
+//   BINARY_OP  main_token = operator,   lhs/rhs = operand nodes
+//   VAR_DECL   main_token = identifier, lhs = expression node, rhs = type token
+struct FlatAst
+{
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    std::vector<NodeKind> kinds;
+    std::vector<uint32_t> main_tokens;
+    std::vector<uint32_t> lhs;
+    std::vector<uint32_t> rhs;
+    std::vector<Token> tokens;
+
+    size_t size() const { return kinds.size(); }
+
+    int64_t numberValue(uint32_t node) const
+    {
+        return static_cast<int64_t>(static_cast<uint64_t>(rhs[node]) << 32 | lhs[node]);
+    }
+
+    uint32_t addToken(const Token &token)
+    {
+        tokens.push_back(token);
+        return static_cast<uint32_t>(tokens.size() - 1);
+    }
+
+    uint32_t addNode(NodeKind kind, uint32_t main_token, uint32_t left = NONE, uint32_t right = NONE)
+    {
+        kinds.push_back(kind);
+        main_tokens.push_back(main_token);
+        lhs.push_back(left);
+        rhs.push_back(right);
+        return static_cast<uint32_t>(kinds.size() - 1);
+    }
+
+    void clear()
+    {
+        kinds.clear();
+        main_tokens.clear();
+        lhs.clear();
+        rhs.clear();
+        tokens.clear();
+    }
+};
+
+// Parser back end that allocates pointer-linked nodes in an Arena.
+class TreeBuilder
+{
+public:
+    using NodeRef = AstNode *;
+
+    TreeBuilder(Arena &arena) : arena(arena) {}
+
+    NodeRef number(const Token &token, int64_t value) { return arena.make<NumberNode>(token, value); }
+    NodeRef variable(const Token &identifier) { return arena.make<VariableNode>(identifier); }
+    NodeRef binaryOp(NodeRef left, const Token &op, NodeRef right) { return arena.make<BinaryOpNode>(left, op, right); }
+    NodeRef varDecl(const Token &type, const Token &identifier, NodeRef expression)
+    {
+        return arena.make<VarDeclNode>(type, identifier, expression);
+    }
+
+private:
+    Arena &arena;
+};
+
+// A node in a FlatAst; default-constructed refs are null.
+struct FlatNodeRef
+{
+    uint32_t index = FlatAst::NONE;
+    explicit operator bool() const { return index != FlatAst::NONE; }
+};
+
+// Parser back end that appends nodes to a FlatAst.
+class FlatBuilder
+{
+public:
+    using NodeRef = FlatNodeRef;
+
+    FlatBuilder(FlatAst &ast) : ast(ast) {}
+
+    NodeRef number(const Token &token, int64_t value)
+    {
+        uint64_t bits = static_cast<uint64_t>(value);
+        return {ast.addNode(NodeKind::NUMBER, ast.addToken(token), static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32))};
+    }
+    NodeRef variable(const Token &identifier) { return {ast.addNode(NodeKind::VARIABLE, ast.addToken(identifier))}; }
+    NodeRef binaryOp(NodeRef left, const Token &op, NodeRef right)
+    {
+        return {ast.addNode(NodeKind::BINARY_OP, ast.addToken(op), left.index, right.index)};
+    }
+    NodeRef varDecl(const Token &type, const Token &identifier, NodeRef expression)
+    {
+        uint32_t identifier_token = ast.addToken(identifier);
+        return {ast.addNode(NodeKind::VAR_DECL, identifier_token, expression.index, ast.addToken(type))};
+    }
+
+private:
+    FlatAst &ast;
+};
+
+#endif
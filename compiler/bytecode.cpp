@@ -0,0 +1,81 @@
+#include "bytecode.h"
+
+ArithStatus VirtualMachine::run(const BytecodeProgram &program, std::vector<int64_t> &variables, size_t &failed_offset)
+{
+    variables.assign(program.slot_symbols.size(), 0);
+    stack.resize(program.max_stack + 1);
+    const uint8_t *code = program.code.data();
+    const uint8_t *ip = code;
+    int64_t *sp = stack.data(); // one past the top of the operand stack
+    int64_t *vars = variables.data();
+    ArithStatus status = ArithStatus::OK;
+
+#if defined(__GNUC__)
+    // Indexed by OpCode; keep in the same order as the enum.
+    static void *const DISPATCH_TABLE[] = {&&op_push, &&op_load, &&op_store, &&op_add,
+                                           &&op_sub,  &&op_mul,  &&op_div,   &&op_halt};
+#define VM_CASE(label, op) label:
+#define VM_NEXT() goto *DISPATCH_TABLE[*ip++]
+    VM_NEXT();
+#else
+#define VM_CASE(label, op) case OpCode::op:
+#define VM_NEXT() continue
+    for (;;)
+    {
+        switch (static_cast<OpCode>(*ip++))
+        {
+#endif
+
+#define VM_BINARY(label, op, checked)            \
+    VM_CASE(label, op)                           \
+    {                                            \
+        sp--;                                    \
+        status = checked(sp[-1], sp[0], sp[-1]); \
+        if (status != ArithStatus::OK)           \
+            goto fail;                           \
+        VM_NEXT();                               \
+    }
+
+    VM_CASE(op_push, PUSH)
+    {
+        std::memcpy(sp++, ip, sizeof(int64_t));
+        ip += sizeof(int64_t);
+        VM_NEXT();
+    }
+    VM_CASE(op_load, LOAD)
+    {
+        uint32_t slot;
+        std::memcpy(&slot, ip, sizeof(slot));
+        ip += sizeof(slot);
+        *sp++ = vars[slot];
+        VM_NEXT();
+    }
+    VM_CASE(op_store, STORE)
+    {
+        uint32_t slot;
+        std::memcpy(&slot, ip, sizeof(slot));
+        ip += sizeof(slot);
+        vars[slot] = *--sp;
+        VM_NEXT();
+    }
+    VM_BINARY(op_add, ADD, checkedAdd)
+    VM_BINARY(op_sub, SUB, checkedSubtract)
+    VM_BINARY(op_mul, MUL, checkedMultiply)
+    VM_BINARY(op_div, DIV, checkedDivide)
+    VM_CASE(op_halt, HALT)
+    {
+        return ArithStatus::OK;
+    }
+
+#if !defined(__GNUC__)
+        }
+    }
+#endif
+#undef VM_BINARY
+#undef VM_NEXT
+#undef VM_CASE
+
+fail:
+    failed_offset = static_cast<size_t>(ip - 1 - code);
+    return status;
+}
@@ -0,0 +1,246 @@
+#ifndef MINI_COMPILER_BYTECODE_H
+#define MINI_COMPILER_BYTECODE_H
+
+#include "arith.h"
+#include "ast.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Instructions of the stack bytecode. Operands are stored inline after the opcode:
+//   PUSH   8-byte constant          pushes the constant
+//   LOAD   4-byte variable slot     pushes the slot's value
+//   STORE  4-byte variable slot     pops a value into the slot
+//   ADD, SUB, MUL, DIV              pop two operands, push the checked result
+//   HALT                            ends the program
+enum class OpCode : uint8_t
+{
+    PUSH,
+    LOAD,
+    STORE,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    HALT
+};
+
+// Size of an instruction including its operand.
+constexpr size_t instructionSize(OpCode op)
+{
+    switch (op)
+    {
+    case OpCode::PUSH:
+        return 1 + sizeof(int64_t);
+    case OpCode::LOAD:
+    case OpCode::STORE:
+        return 1 + sizeof(uint32_t);
+    default:
+        return 1;
+    }
+}
+
+// A compiled program. Variable slots are numbered in order of first mention, where a
+// declaration mentions its own name before the names its expression reads.
+struct BytecodeProgram
+{
+    std::vector<uint8_t> code;
+    std::vector<uint32_t> slot_symbols; // symbol ID of each variable slot
+    size_t max_stack = 0;               // deepest operand stack the code needs
+};
+
+// Numbers variables in order of first mention. Shared by the back ends so the
+// bytecode VM and the JIT agree on variable slots.
+class SlotAllocator
+{
+public:
+    uint32_t slotFor(uint32_t symbol)
+    {
+        if (symbol_slots.size() <= symbol)
+            symbol_slots.resize(symbol + 1, NO_SLOT);
+        if (symbol_slots[symbol] == NO_SLOT)
+        {
+            symbol_slots[symbol] = static_cast<uint32_t>(slot_symbols.size());
+            slot_symbols.push_back(symbol);
+        }
+        return symbol_slots[symbol];
+    }
+
+    // Slot of a symbol that slotFor() has already numbered.
+    uint32_t slotOf(uint32_t symbol) const { return symbol_slots[symbol]; }
+
+    // Symbol ID of each slot.
+    const std::vector<uint32_t> &symbols() const { return slot_symbols; }
+
+    void clear()
+    {
+        symbol_slots.clear();
+        slot_symbols.clear();
+    }
+
+private:
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    std::vector<uint32_t> symbol_slots; // slot of each symbol ID, or NO_SLOT
+    std::vector<uint32_t> slot_symbols;
+};
+
+// Lowers a list of VarDeclNode statements into linear bytecode. Expressions are emitted
+// in post-order with an explicit stack, so deep trees are safe.
+class BytecodeCompiler
+{
+public:
+    BytecodeProgram compile(const std::vector<AstNode *> &statements)
+    {
+        begin();
+        for (const AstNode *statement : statements)
+        {
+            auto decl = nodeAs<VarDeclNode>(statement);
+            uint32_t slot = slots.slotFor(decl->identifier.symbol);
+            emitExpression(decl->expression, true);
+            emit(OpCode::STORE);
+            emitOperand(slot);
+        }
+        return finish();
+    }
+
+    // Emits only the code that leaves root's value on the stack, with no STORE or HALT.
+    // Such a fragment names no variable slot: its LOAD operands are symbol IDs, which
+    // appendDeclaration() turns into slots, so it can be spliced into any program.
+    BytecodeProgram compileExpression(const AstNode *root)
+    {
+        program = BytecodeProgram();
+        emitExpression(root, false);
+        return std::move(program);
+    }
+
+    // Starts an empty program to be assembled with appendDeclaration().
+    void begin()
+    {
+        program = BytecodeProgram();
+        slots.clear();
+    }
+
+    // Appends a declaration of symbol whose value is computed by expression, a fragment
+    // made by compileExpression(), possibly by another compiler or an earlier run. With
+    // load_symbols set, each LOAD operand is an index into it instead of a symbol ID.
+    void appendDeclaration(const BytecodeProgram &expression, uint32_t symbol, const uint32_t *load_symbols = nullptr)
+    {
+        uint32_t slot = slots.slotFor(symbol);
+        size_t start = program.code.size();
+        program.code.insert(program.code.end(), expression.code.begin(), expression.code.end());
+        for (size_t pos = start; pos < program.code.size();)
+        {
+            OpCode op = static_cast<OpCode>(program.code[pos]);
+            pos += instructionSize(op);
+            if (op != OpCode::LOAD)
+                continue;
+            uint32_t operand;
+            std::memcpy(&operand, &program.code[pos - sizeof(operand)], sizeof(operand));
+            operand = slots.slotFor(load_symbols ? load_symbols[operand] : operand);
+            std::memcpy(&program.code[pos - sizeof(operand)], &operand, sizeof(operand));
+        }
+        program.max_stack = std::max(program.max_stack, expression.max_stack);
+        emit(OpCode::STORE);
+        emitOperand(slot);
+    }
+
+    // Ends the program started by begin().
+    BytecodeProgram finish()
+    {
+        emit(OpCode::HALT);
+        program.slot_symbols = slots.symbols();
+        return std::move(program);
+    }
+
+private:
+    BytecodeProgram program;
+    SlotAllocator slots;
+    std::vector<std::pair<const AstNode *, bool>> stack;
+
+    void emit(OpCode op) { program.code.push_back(static_cast<uint8_t>(op)); }
+
+    template <typename T>
+    void emitOperand(T value)
+    {
+        size_t at = program.code.size();
+        program.code.resize(at + sizeof(T));
+        std::memcpy(program.code.data() + at, &value, sizeof(T));
+    }
+
+    // LOAD operands are slots when resolve_slots is set, and symbol IDs otherwise.
+    void emitExpression(const AstNode *root, bool resolve_slots)
+    {
+        size_t depth = 0;
+        stack.assign(1, {root, false});
+        while (!stack.empty())
+        {
+            auto [node, children_done] = stack.back();
+            stack.pop_back();
+            switch (node->kind)
+            {
+            case NodeKind::NUMBER:
+                emit(OpCode::PUSH);
+                emitOperand(static_cast<const NumberNode *>(node)->value);
+                program.max_stack = std::max(program.max_stack, ++depth);
+                break;
+            case NodeKind::VARIABLE:
+            {
+                uint32_t symbol = static_cast<const VariableNode *>(node)->identifier.symbol;
+                emit(OpCode::LOAD);
+                emitOperand(resolve_slots ? slots.slotFor(symbol) : symbol);
+                program.max_stack = std::max(program.max_stack, ++depth);
+                break;
+            }
+            case NodeKind::BINARY_OP:
+            {
+                auto p = static_cast<const BinaryOpNode *>(node);
+                if (!children_done)
+                {
+                    stack.push_back({p, true});
+                    stack.push_back({p->right, false});
+                    stack.push_back({p->left, false});
+                    break;
+                }
+                emit(binaryOpCode(p->op.type));
+                depth--;
+                break;
+            }
+            case NodeKind::VAR_DECL:
+                break;
+            }
+        }
+    }
+
+    static OpCode binaryOpCode(TokenType type)
+    {
+        switch (type)
+        {
+        case TokenType::OPERATOR_PLUS:
+            return OpCode::ADD;
+        case TokenType::OPERATOR_MINUS:
+            return OpCode::SUB;
+        case TokenType::OPERATOR_MULTIPLY:
+            return OpCode::MUL;
+        default:
+            return OpCode::DIV;
+        }
+    }
+};
+
+// Executes BytecodeProgram code. Dispatch uses computed goto where the compiler supports
+// it (GCC and Clang) and a switch loop elsewhere. Variables are indexed by slot.
+class VirtualMachine
+{
+public:
+    // Runs program and stores each variable's value in variables. On failure returns the
+    // status and the code offset of the failing instruction in failed_offset.
+    ArithStatus run(const BytecodeProgram &program, std::vector<int64_t> &variables, size_t &failed_offset);
+
+private:
+    std::vector<int64_t> stack;
+};
+
+#endif
@@ -0,0 +1,199 @@
+#include "cache.h"
+
+#include "parser.h"
+#include "passes.h"
+
+#include <algorithm>
+#include <cstdio>
+
+bool CompileCache::save(const std::string &path, std::ostream &errors) const
+{
+    std::string temporary = path + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+    {
+        errors << "Error: Cannot write " << temporary << "\n";
+        return false;
+    }
+    bool ok = std::fwrite(FILE_MAGIC, 1, sizeof(FILE_MAGIC), file) == sizeof(FILE_MAGIC);
+    for (auto entry = entries.rbegin(); ok && entry != entries.rend(); ++entry)
+    {
+        FileEntry header{entry->hash, static_cast<uint32_t>(entry->key.size()),
+                         static_cast<uint32_t>(entry->code.code.size()), entry->code.max_stack};
+        ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+             std::fwrite(entry->key.data(), 1, entry->key.size(), file) == entry->key.size() &&
+             std::fwrite(entry->code.code.data(), 1, entry->code.code.size(), file) == entry->code.code.size();
+    }
+    ok = std::fclose(file) == 0 && ok;
+    if (ok && std::rename(temporary.c_str(), path.c_str()) != 0)
+        ok = false;
+    if (!ok)
+        errors << "Error: Failed to write " << path << "\n";
+    return ok;
+}
+
+bool CompileCache::load(const std::string &path, std::ostream &errors)
+{
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return true;
+    std::string data;
+    char chunk[64 * 1024];
+    size_t count;
+    while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        data.append(chunk, count);
+    }
+    std::fclose(file);
+
+    std::vector<Entry> loaded;
+    bool ok = data.compare(0, sizeof(FILE_MAGIC), FILE_MAGIC, sizeof(FILE_MAGIC)) == 0;
+    for (size_t pos = sizeof(FILE_MAGIC); ok && pos < data.size();)
+    {
+        FileEntry header;
+        ok = data.size() - pos >= sizeof(header);
+        if (!ok)
+            break;
+        std::memcpy(&header, data.data() + pos, sizeof(header));
+        pos += sizeof(header);
+        ok = data.size() - pos >= size_t(header.key_size) + header.code_size;
+        if (!ok)
+            break;
+        Entry entry{header.hash, data.substr(pos, header.key_size), {}};
+        pos += header.key_size;
+        entry.code.code.assign(data.begin() + pos, data.begin() + pos + header.code_size);
+        entry.code.max_stack = header.max_stack;
+        pos += header.code_size;
+        ok = validFragment(entry.code, entry.key);
+        loaded.push_back(std::move(entry));
+    }
+    if (!ok)
+    {
+        errors << "Error: " << path << " is not a valid compile cache\n";
+        return false;
+    }
+    for (Entry &entry : loaded)
+    {
+        insert(std::move(entry.key), entry.hash, std::move(entry.code));
+    }
+    return true;
+}
+
+bool CompileCache::validFragment(const BytecodeProgram &fragment, std::string_view key)
+{
+    // Token text never holds bytes below ' ', so every IDENTIFIER byte is a type byte.
+    size_t identifiers = std::count(key.begin(), key.end(), static_cast<char>(TokenType::IDENTIFIER));
+    const std::vector<uint8_t> &code = fragment.code;
+    size_t depth = 0;
+    size_t deepest = 0;
+    for (size_t pos = 0; pos < code.size();)
+    {
+        switch (static_cast<OpCode>(code[pos++]))
+        {
+        case OpCode::PUSH:
+            if (code.size() - pos < sizeof(int64_t))
+                return false;
+            pos += sizeof(int64_t);
+            deepest = std::max(deepest, ++depth);
+            break;
+        case OpCode::LOAD:
+        {
+            uint32_t operand;
+            if (code.size() - pos < sizeof(operand))
+                return false;
+            std::memcpy(&operand, &code[pos], sizeof(operand));
+            if (operand >= identifiers)
+                return false;
+            pos += sizeof(operand);
+            deepest = std::max(deepest, ++depth);
+            break;
+        }
+        case OpCode::ADD:
+        case OpCode::SUB:
+        case OpCode::MUL:
+        case OpCode::DIV:
+            if (depth < 2)
+                return false;
+            depth--;
+            break;
+        default:
+            return false;
+        }
+    }
+    return depth == 1 && deepest == fragment.max_stack;
+}
+
+bool compileWithCache(std::string_view source, Interner &interner, CompileCache &cache, BytecodeProgram &program,
+                      std::ostream &errors)
+{
+    BytecodeCompiler assembler;
+    BytecodeCompiler fragments;
+    Arena arena;
+    std::string key;
+    std::vector<uint32_t> identifiers; // symbol of each identifier token in the declaration
+    Diagnostics diagnostics(source);
+    assembler.begin();
+    for (size_t start = 0; start < source.size();)
+    {
+        size_t end = std::min(source.find(';', start), source.size() - 1) + 1;
+        std::string_view piece = source.substr(start, end - start);
+        start = end;
+
+        // Each token is encoded as its type byte followed by its text. Only declarations
+        // that parse are cached, and their token text never holds bytes below ' ', so the
+        // encoding cannot be ambiguous.
+        key.clear();
+        identifiers.clear();
+        Lexer lexer(piece, interner);
+        for (Token token = lexer.getNextToken(); token.type != TokenType::END_OF_FILE; token = lexer.getNextToken())
+        {
+            if (token.symbol != NO_SYMBOL)
+                identifiers.push_back(token.symbol);
+            key += static_cast<char>(token.type);
+            key += token.value;
+        }
+        if (key.empty())
+            continue;
+        uint64_t hash = hashBytes(key.data(), key.size());
+        if (const BytecodeProgram *cached = cache.find(key, hash))
+        {
+            assembler.appendDeclaration(*cached, identifiers.front(), identifiers.data());
+            continue;
+        }
+
+        arena.reset();
+        Lexer statement_lexer(piece, interner);
+        Parser parser(statement_lexer, arena, diagnostics);
+        std::vector<AstNode *> statements;
+        if (!parser.parseProgram(statements))
+            continue;
+        AstNode *statement = statements.front();
+        FoldStats stats = foldConstants(statement, errors);
+        auto decl = nodeAs<VarDeclNode>(statement);
+        BytecodeProgram fragment = fragments.compileExpression(decl->expression);
+        assembler.appendDeclaration(fragment, decl->identifier.symbol);
+        if (stats.overflowed != 0)
+            continue;
+        // Turn the LOAD operands from symbol IDs into the index of the first identifier
+        // token with that symbol, which the key determines.
+        for (size_t pos = 0; pos < fragment.code.size();)
+        {
+            OpCode op = static_cast<OpCode>(fragment.code[pos]);
+            pos += instructionSize(op);
+            if (op != OpCode::LOAD)
+                continue;
+            uint32_t operand;
+            std::memcpy(&operand, &fragment.code[pos - sizeof(operand)], sizeof(operand));
+            operand = static_cast<uint32_t>(std::find(identifiers.begin(), identifiers.end(), operand) - identifiers.begin());
+            std::memcpy(&fragment.code[pos - sizeof(operand)], &operand, sizeof(operand));
+        }
+        cache.insert(key, hash, std::move(fragment));
+    }
+    if (!diagnostics.empty())
+    {
+        diagnostics.print(errors);
+        return false;
+    }
+    program = assembler.finish();
+    return true;
+}
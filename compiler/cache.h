@@ -0,0 +1,124 @@
+#ifndef MINI_COMPILER_CACHE_H
+#define MINI_COMPILER_CACHE_H
+
+#include "bytecode.h"
+#include "interner.h"
+
+#include <iostream>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Expression fragments from BytecodeCompiler::compileExpression, keyed by a hash of the
+// declaration's token stream, so declarations seen before in another file or an earlier
+// run skip parsing, folding and code generation. Symbol IDs differ from run to run, so a
+// cached fragment's LOAD operands instead count identifier tokens in the key (0 is the
+// declared name). Entries are evicted least recently used once their total size passes
+// max_bytes. save() and load() keep the cache across runs in a file with native byte
+// order, meant for the machine that wrote it.
+class CompileCache
+{
+public:
+    explicit CompileCache(size_t max_bytes = 64 * 1024 * 1024) : max_bytes(max_bytes) {}
+    CompileCache(const CompileCache &) = delete;
+    CompileCache &operator=(const CompileCache &) = delete;
+
+    // Returns the fragment for key, or nullptr. key is compared in full, so a hash
+    // collision is a miss rather than wrong code.
+    const BytecodeProgram *find(std::string_view key, uint64_t hash)
+    {
+        auto found = index.find(hash);
+        if (found == index.end() || found->second->key != key)
+        {
+            miss_count++;
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, found->second);
+        hit_count++;
+        return &found->second->code;
+    }
+
+    // Adds a fragment, replacing any entry with the same hash.
+    void insert(std::string key, uint64_t hash, BytecodeProgram code)
+    {
+        auto found = index.find(hash);
+        if (found != index.end())
+            erase(found->second);
+        entries.push_front({hash, std::move(key), std::move(code)});
+        index[hash] = entries.begin();
+        used_bytes += entryBytes(entries.front());
+        while (used_bytes > max_bytes && entries.size() > 1)
+        {
+            erase(std::prev(entries.end()));
+            eviction_count++;
+        }
+    }
+
+    size_t size() const { return entries.size(); }
+    size_t bytes() const { return used_bytes; }
+    size_t hits() const { return hit_count; }
+    size_t misses() const { return miss_count; }
+    size_t evictions() const { return eviction_count; }
+
+    // Writes every entry to path, least recently used first so load() restores the order.
+    // The file is written next to path and renamed over it, so readers never see half of it.
+    bool save(const std::string &path, std::ostream &errors = std::cerr) const;
+
+    // Adds the entries saved in path. A missing file is an empty cache. A file that is
+    // damaged or holds invalid code is rejected as a whole and returns false.
+    bool load(const std::string &path, std::ostream &errors = std::cerr);
+
+private:
+    static constexpr char FILE_MAGIC[8] = {'M', 'C', 'C', 'A', 'C', 'H', 'E', '2'};
+
+    struct Entry
+    {
+        uint64_t hash;
+        std::string key;
+        BytecodeProgram code;
+    };
+
+    // Header of each entry in a cache file, followed by the key and code bytes.
+    struct FileEntry
+    {
+        uint64_t hash;
+        uint32_t key_size;
+        uint32_t code_size;
+        uint64_t max_stack;
+    };
+
+    size_t max_bytes;
+    size_t used_bytes = 0;
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+    size_t eviction_count = 0;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+
+    static size_t entryBytes(const Entry &entry) { return sizeof(Entry) + entry.key.size() + entry.code.code.size(); }
+
+    void erase(std::list<Entry>::iterator entry)
+    {
+        used_bytes -= entryBytes(*entry);
+        index.erase(entry->hash);
+        entries.erase(entry);
+    }
+
+    // Checks that code is a well-formed expression fragment for key, so a damaged file
+    // cannot make the VM read past its code, operand stack or variables.
+    static bool validFragment(const BytecodeProgram &fragment, std::string_view key);
+};
+
+// Compiles source into program with the same result as parsing it, folding constants and
+// running BytecodeCompiler::compile, but looks every declaration up in cache first. The
+// key is the declaration's token stream, so spacing does not matter. Only misses are
+// parsed, folded and compiled, and then cached; a declaration whose folding reported an
+// error is not cached, so its message is repeated on every run. A declaration that fails to
+// parse is skipped and the rest are still compiled and cached; all parse errors are printed
+// at the end and false is returned.
+bool compileWithCache(std::string_view source, Interner &interner, CompileCache &cache, BytecodeProgram &program,
+                      std::ostream &errors = std::cerr);
+
+#endif
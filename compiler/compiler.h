@@ -0,0 +1,35 @@
+#ifndef MINI_COMPILER_COMPILER_H
+#define MINI_COMPILER_COMPILER_H
+
+// Everything the library offers, for programs that would rather not pick headers.
+//
+// The library builds into a static archive that programs link instead of recompiling
+// compiler/*.cpp each time, from the repository root:
+//   mkdir -p build && (cd build && g++ -std=c++17 -O2 -c ../compiler/*.cpp && ar rcs libminicompiler.a *.o)
+//   g++ -std=c++17 -O2 parser.cpp build/libminicompiler.a -lpthread -o parser
+
+#include "arena.h"
+#include "arith.h"
+#include "ast.h"
+#include "bytecode.h"
+#include "cache.h"
+#include "context.h"
+#include "diagnostics.h"
+#include "driver.h"
+#include "image.h"
+#include "incremental.h"
+#include "interner.h"
+#include "jit.h"
+#include "lexer.h"
+#include "output.h"
+#include "parallel_lexer.h"
+#include "parser.h"
+#include "passes.h"
+#include "semantic.h"
+#include "server.h"
+#include "source_file.h"
+#include "stats.h"
+#include "thread_pool.h"
+#include "token.h"
+
+#endif
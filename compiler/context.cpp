@@ -0,0 +1,64 @@
+#include "context.h"
+
+#include "lexer.h"
+#include "parallel_lexer.h"
+#include "parser.h"
+#include "passes.h"
+
+void CompilerContext::reset()
+{
+    node_arena.reset();
+    symbols.clear();
+    flat_ast.clear();
+    token_buffer.clear();
+    statement_buffer.clear();
+}
+
+const std::vector<Token> &CompilerContext::tokenize(std::string_view source)
+{
+    reset();
+    Lexer lexer(source, symbols);
+    for (Token token = lexer.getNextToken(); token.type != TokenType::END_OF_FILE; token = lexer.getNextToken())
+    {
+        token_buffer.push_back(token);
+    }
+    return token_buffer;
+}
+
+const std::vector<Token> &CompilerContext::tokenizeParallel(std::string_view source, size_t thread_count)
+{
+    reset();
+    lexParallel(source, symbols, token_buffer, thread_count);
+    return token_buffer;
+}
+
+bool CompilerContext::parse(std::string_view source, std::vector<AstNode *> &statements, std::ostream &errors)
+{
+    reset();
+    Lexer lexer(source, symbols);
+    Parser parser(lexer, node_arena, errors);
+    return parser.parseProgram(statements);
+}
+
+bool CompilerContext::parseFlat(std::string_view source, std::vector<FlatNodeRef> &statements, std::ostream &errors)
+{
+    reset();
+    Lexer lexer(source, symbols);
+    FlatParser parser(lexer, flat_ast, errors);
+    return parser.parseProgram(statements);
+}
+
+bool CompilerContext::compile(std::string_view source, BytecodeProgram &program, std::ostream &errors)
+{
+    reset();
+    Lexer lexer(source, symbols);
+    Parser parser(lexer, node_arena, errors);
+    if (!parser.parseProgram(statement_buffer))
+        return false;
+    for (AstNode *&statement : statement_buffer)
+    {
+        foldConstants(statement, errors);
+    }
+    program = compiler.compile(statement_buffer);
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef MINI_COMPILER_CONTEXT_H
+#define MINI_COMPILER_CONTEXT_H
+
+#include "arena.h"
+#include "ast.h"
+#include "bytecode.h"
+#include "interner.h"
+#include "token.h"
+
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+// Everything one compilation needs, kept between compilations so a long-running process
+// can compile millions of snippets without reallocating: the node Arena, the Interner,
+// the FlatAst, a token buffer and the bytecode compiler's scratch space. reset() forgets
+// the previous compilation but keeps all of that memory. Every entry point resets first,
+// so tokens, trees and symbol names it returns stay valid until the next call. The
+// source text must outlive them too, because tokens view it.
+class CompilerContext
+{
+public:
+    CompilerContext() = default;
+    CompilerContext(const CompilerContext &) = delete;
+    CompilerContext &operator=(const CompilerContext &) = delete;
+
+    // Forgets the previous compilation. The arena resets in O(1), and the interner in
+    // time proportional to the symbols it held.
+    void reset();
+
+    // Lexes all of source into the token buffer, END_OF_FILE excluded.
+    const std::vector<Token> &tokenize(std::string_view source);
+
+    // Like tokenize, with the tokens lexed on several threads by lexParallel.
+    const std::vector<Token> &tokenizeParallel(std::string_view source, size_t thread_count = 0);
+
+    // Parses source into pointer-linked nodes allocated in arena().
+    bool parse(std::string_view source, std::vector<AstNode *> &statements, std::ostream &errors = std::cerr);
+
+    // Parses source into flatAst().
+    bool parseFlat(std::string_view source, std::vector<FlatNodeRef> &statements, std::ostream &errors = std::cerr);
+
+    // Parses source, folds constant expressions and compiles the result to bytecode.
+    bool compile(std::string_view source, BytecodeProgram &program, std::ostream &errors = std::cerr);
+
+    Arena &arena() { return node_arena; }
+    Interner &interner() { return symbols; }
+    FlatAst &flatAst() { return flat_ast; }
+    const std::vector<Token> &tokens() const { return token_buffer; }
+
+private:
+    Arena node_arena;
+    Interner symbols;
+    FlatAst flat_ast;
+    std::vector<Token> token_buffer;
+    std::vector<AstNode *> statement_buffer;
+    BytecodeCompiler compiler;
+};
+
+#endif
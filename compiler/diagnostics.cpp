@@ -0,0 +1,93 @@
+#include "diagnostics.h"
+
+#include <string>
+
+const char *diagnosticMessage(DiagnosticCode code)
+{
+    switch (code)
+    {
+    case DiagnosticCode::EXPECTED_DECLARATION:
+        return "Expected a declaration";
+    case DiagnosticCode::EXPECTED_IDENTIFIER:
+        return "Expected an identifier after int";
+    case DiagnosticCode::EXPECTED_ASSIGN:
+        return "Expected equals sign";
+    case DiagnosticCode::EXPECTED_SEMICOLON:
+        return "Expected semicolon";
+    case DiagnosticCode::EXPECTED_OPERAND:
+        return "Expected a number or identifier";
+    case DiagnosticCode::EXPECTED_OPERAND_AFTER_OPERATOR:
+        return "Expected a number or identifier after operator";
+    case DiagnosticCode::EXPECTED_CLOSING_PARENTHESIS:
+        return "Expected closing parenthesis";
+    case DiagnosticCode::LITERAL_OUT_OF_RANGE:
+        return "Integer literal is out of range";
+    case DiagnosticCode::DUPLICATE_DECLARATION:
+        return "Variable is already declared";
+    case DiagnosticCode::UNDEFINED_VARIABLE:
+        return "Variable is used before it is declared";
+    }
+    return "Unknown error";
+}
+
+void Diagnostics::append(const Diagnostics &other, size_t shift)
+{
+    entries.reserve(entries.size() + other.entries.size());
+    for (Diagnostic diagnostic : other.entries)
+    {
+        diagnostic.offset += shift;
+        entries.push_back(diagnostic);
+    }
+}
+
+void Diagnostics::print(std::ostream &out) const
+{
+    if (entries.empty())
+        return;
+    // Diagnostics arrive in source order, so the line count only moves forward; one that
+    // does not restarts the count from the top.
+    std::string text;
+    size_t line = 1;
+    size_t line_start = 0;
+    size_t scanned = 0;
+    for (const Diagnostic &diagnostic : entries)
+    {
+        if (diagnostic.offset < scanned)
+        {
+            line = 1;
+            line_start = 0;
+            scanned = 0;
+        }
+        for (; scanned < diagnostic.offset; scanned++)
+        {
+            if (source[scanned] == '\n')
+            {
+                line++;
+                line_start = scanned + 1;
+            }
+        }
+        text += "Error: line ";
+        text += std::to_string(line);
+        text += ", column ";
+        text += std::to_string(diagnostic.offset - line_start + 1);
+        text += ": ";
+        std::string_view token = source.substr(diagnostic.offset, diagnostic.length);
+        switch (diagnostic.code)
+        {
+        case DiagnosticCode::LITERAL_OUT_OF_RANGE:
+            text.append("Integer literal ").append(token).append(" is out of range");
+            break;
+        case DiagnosticCode::DUPLICATE_DECLARATION:
+            text.append("Variable ").append(token).append(" is already declared");
+            break;
+        case DiagnosticCode::UNDEFINED_VARIABLE:
+            text.append("Variable ").append(token).append(" is used before it is declared");
+            break;
+        default:
+            text += diagnosticMessage(diagnostic.code);
+            break;
+        }
+        text += '\n';
+    }
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
@@ -0,0 +1,68 @@
+#ifndef MINI_COMPILER_DIAGNOSTICS_H
+#define MINI_COMPILER_DIAGNOSTICS_H
+
+#include "token.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+// The errors a Diagnostics can hold. Each maps to a fixed message in
+// diagnosticMessage(); some quote the token's text when they are printed.
+enum class DiagnosticCode : uint8_t
+{
+    EXPECTED_DECLARATION,
+    EXPECTED_IDENTIFIER,
+    EXPECTED_ASSIGN,
+    EXPECTED_SEMICOLON,
+    EXPECTED_OPERAND,
+    EXPECTED_OPERAND_AFTER_OPERATOR,
+    EXPECTED_CLOSING_PARENTHESIS,
+    LITERAL_OUT_OF_RANGE,
+    DUPLICATE_DECLARATION, // from SemanticAnalyzer
+    UNDEFINED_VARIABLE
+};
+
+const char *diagnosticMessage(DiagnosticCode code);
+
+// One error, at the token where it was found.
+struct Diagnostic
+{
+    DiagnosticCode code;
+    uint32_t length; // of the token text
+    size_t offset;   // of the token text, from the start of the source
+};
+
+// Collects errors as plain records, so reporting one is a push_back instead of a
+// formatted write to an unbuffered stream. Lines and columns are only worked out in
+// print(), in a single pass over the source.
+class Diagnostics
+{
+public:
+    // Every reported token must view into source, which offsets are measured from.
+    explicit Diagnostics(std::string_view source = {}) : source(source) {}
+
+    void report(DiagnosticCode code, const Token &token)
+    {
+        entries.push_back({code, static_cast<uint32_t>(token.value.size()),
+                           static_cast<size_t>(token.value.data() - source.data())});
+    }
+
+    // Appends the diagnostics of other, whose source starts shift bytes into this one's.
+    void append(const Diagnostics &other, size_t shift);
+
+    void clear() { entries.clear(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    const Diagnostic &operator[](size_t index) const { return entries[index]; }
+
+    // Writes "Error: line L, column C: message" for every diagnostic, in one write.
+    void print(std::ostream &out) const;
+
+private:
+    std::string_view source;
+    std::vector<Diagnostic> entries;
+};
+
+#endif
@@ -0,0 +1,372 @@
+#include "driver.h"
+
+#include "image.h"
+#include "jit.h"
+#include "parallel_lexer.h"
+#include "parser.h"
+#include "passes.h"
+#include "semantic.h"
+#include "source_file.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+void printVariables(const std::vector<int64_t> &variables, const std::vector<uint32_t> &slot_symbols,
+                    const Interner &interner, std::ostream &out)
+{
+    out << "Program Output:\n";
+    for (size_t slot = 0; slot < variables.size(); slot++)
+    {
+        out << interner.name(slot_symbols[slot]) << " = " << variables[slot] << "\n";
+    }
+}
+
+bool runBytecode(const BytecodeProgram &program, const Interner &interner, CompileStats *stats, std::ostream &out,
+                 std::ostream &errors)
+{
+    std::vector<int64_t> variables;
+    {
+        PhaseTimer phase(stats, "run");
+        size_t failed_offset;
+        ArithStatus status = VirtualMachine().run(program, variables, failed_offset);
+        if (status != ArithStatus::OK)
+        {
+            errors << "Error: " << arithStatusMessage(status) << " at bytecode offset " << failed_offset << "\n";
+            return false;
+        }
+    }
+    PhaseTimer phase(stats, "print");
+    printVariables(variables, program.slot_symbols, interner, out);
+    return true;
+}
+
+bool compileSource(std::string_view code, const DriverOptions &options, Arena &arena, Interner &interner,
+                   std::ostream &out, std::ostream &errors)
+{
+    // Lexing is interleaved with parsing, so the "parse" phase covers both and reports
+    // the tokens lexed.
+    CompileStats *stats = options.stats;
+    if (options.cache)
+    {
+        BytecodeProgram program;
+        {
+            PhaseTimer phase(stats, "compile");
+            size_t hits = options.cache->hits();
+            size_t misses = options.cache->misses();
+            if (!compileWithCache(code, interner, *options.cache, program, errors))
+            {
+                errors << "Parsing failed.\n";
+                return false;
+            }
+            phase.count("hits", options.cache->hits() - hits);
+            phase.count("misses", options.cache->misses() - misses);
+            phase.count("code_bytes", program.code.size());
+        }
+        return runBytecode(program, interner, stats, out, errors);
+    }
+
+    if (options.flat)
+    {
+        FlatAst ast;
+        std::vector<FlatNodeRef> statements;
+        {
+            PhaseTimer phase(stats, "parse");
+            Lexer lexer(code, interner);
+            FlatParser parser(lexer, ast, errors);
+            if (!parser.parseProgram(statements))
+            {
+                errors << "Parsing failed.\n";
+                return false;
+            }
+            phase.count("tokens", lexer.tokenCount());
+            phase.count("nodes", ast.kinds.size());
+            phase.count("bytes", ast.kinds.size() * (sizeof(NodeKind) + 3 * sizeof(uint32_t)) +
+                                     ast.tokens.size() * sizeof(Token));
+        }
+        if (options.image)
+        {
+            // The parser does not keep the tokens it consumes, so the stream is lexed again.
+            PhaseTimer phase(stats, "image");
+            std::vector<Token> tokens;
+            if (options.parallel)
+            {
+                lexParallel(code, interner, tokens);
+            }
+            else
+            {
+                Lexer lexer(code, interner);
+                for (Token token = lexer.getNextToken(); token.type != TokenType::END_OF_FILE;
+                     token = lexer.getNextToken())
+                {
+                    tokens.push_back(token);
+                }
+            }
+            if (!writeParseImage(options.image, tokens, ast, statements, interner, errors))
+                return false;
+            phase.count("tokens", tokens.size());
+        }
+        PhaseTimer phase(stats, "print");
+        if (options.json)
+        {
+            printFlatAstJson(ast, statements, out);
+            return true;
+        }
+        out << "Parser Output (Abstract Syntax Tree):\n";
+        for (FlatNodeRef statement : statements)
+        {
+            printFlatAst(ast, statement.index, out);
+        }
+        return true;
+    }
+
+    ParallelParseResult parallel; // owns the nodes of a parallel parse
+    std::vector<AstNode *> statements;
+    {
+        PhaseTimer phase(stats, "parse");
+        bool parsed;
+        size_t allocations = arena.allocations();
+        size_t bytes = arena.bytesAllocated();
+        size_t chunk_allocations = 0; // the parallel parse allocates in its own arenas
+        size_t chunk_bytes = 0;
+        if (options.parallel)
+        {
+            parallel = parseProgramParallel(code, interner, 0, errors);
+            parsed = parallel.ok;
+            statements = std::move(parallel.statements);
+            for (const auto &chunk_arena : parallel.arenas)
+            {
+                chunk_allocations += chunk_arena->allocations();
+                chunk_bytes += chunk_arena->bytesAllocated();
+            }
+            phase.count("tokens", parallel.tokens);
+        }
+        else
+        {
+            Lexer lexer(code, interner);
+            Parser parser(lexer, arena, errors);
+            parsed = parser.parseProgram(statements);
+            phase.count("tokens", lexer.tokenCount());
+        }
+        if (!parsed)
+        {
+            errors << "Parsing failed.\n";
+            return false;
+        }
+        phase.count("statements", statements.size());
+        phase.count("nodes", arena.allocations() - allocations + chunk_allocations);
+        phase.count("bytes", arena.bytesAllocated() - bytes + chunk_bytes);
+        phase.count("symbols", interner.size());
+    }
+
+    if (options.check)
+    {
+        PhaseTimer phase(stats, "check");
+        Diagnostics diagnostics(code);
+        SemanticStats checked = SemanticAnalyzer().analyze(statements, interner.size(), diagnostics);
+        phase.count("declarations", checked.declarations);
+        phase.count("references", checked.references);
+        phase.count("duplicates", checked.duplicates);
+        phase.count("undefined", checked.undefined);
+        if (!diagnostics.empty())
+        {
+            diagnostics.print(errors);
+            errors << "Semantic analysis failed.\n";
+            return false;
+        }
+    }
+
+    if (options.live)
+    {
+        PhaseTimer phase(stats, "eliminate");
+        std::vector<uint32_t> roots;
+        std::string_view names = options.live;
+        while (!names.empty())
+        {
+            size_t comma = std::min(names.find(','), names.size());
+            std::string_view name = names.substr(0, comma);
+            uint32_t symbol = interner.find(name);
+            if (symbol == NO_SYMBOL)
+            {
+                // Every declaration would count as dead, leaving an empty program.
+                errors << "Error: Unknown live variable " << name << "\n";
+                return false;
+            }
+            roots.push_back(symbol);
+            names.remove_prefix(std::min(comma + 1, names.size()));
+        }
+        DeadCodeStats removed = eliminateDeadDeclarations(statements, roots, interner.size());
+        phase.count("removed", removed.declarations_removed);
+        phase.count("removed_nodes", removed.nodes_removed);
+        phase.count("kept", statements.size());
+    }
+
+    if (options.fold)
+    {
+        PhaseTimer phase(stats, "fold");
+        FoldStats total;
+        for (AstNode *&statement : statements)
+        {
+            FoldStats folded = foldConstants(statement, errors);
+            total.folded += folded.folded;
+            total.overflowed += folded.overflowed;
+        }
+        phase.count("folded", total.folded);
+        phase.count("overflowed", total.overflowed);
+    }
+
+    if (options.jit)
+    {
+        JitProgram program;
+        {
+            PhaseTimer phase(stats, "codegen");
+            if (!program.compile(statements))
+                errors << "Note: JIT is not available here, interpreting instead.\n";
+            phase.count("native", program.nativeCount());
+        }
+        std::vector<int64_t> variables;
+        {
+            PhaseTimer phase(stats, "run");
+            size_t failed_statement;
+            ArithStatus status = program.run(variables, failed_statement);
+            if (status != ArithStatus::OK)
+            {
+                errors << "Error: " << arithStatusMessage(status) << " in declaration " << failed_statement + 1 << "\n";
+                return false;
+            }
+        }
+        PhaseTimer phase(stats, "print");
+        printVariables(variables, program.slotSymbols(), interner, out);
+        return true;
+    }
+
+    if (options.run)
+    {
+        BytecodeProgram program;
+        {
+            PhaseTimer phase(stats, "codegen");
+            program = BytecodeCompiler().compile(statements);
+            phase.count("code_bytes", program.code.size());
+        }
+        return runBytecode(program, interner, stats, out, errors);
+    }
+
+    PhaseTimer phase(stats, "print");
+    if (options.json)
+    {
+        printAstJson(statements, out);
+        return true;
+    }
+    out << "Parser Output (Abstract Syntax Tree):\n";
+    for (const AstNode *statement : statements)
+    {
+        printAst(statement, out);
+    }
+    return true;
+}
+
+bool compileSource(std::string_view code, const DriverOptions &options, CompilerContext &context, std::ostream &out,
+                   std::ostream &errors)
+{
+    context.reset();
+    return compileSource(code, options, context.arena(), context.interner(), out, errors);
+}
+
+bool printParseImage(const std::string &path, const DriverOptions &options, std::ostream &out, std::ostream &errors)
+{
+    CompileStats *stats = options.stats;
+    ParseImage image;
+    {
+        PhaseTimer phase(stats, "read");
+        if (!image.open(path, errors))
+            return false;
+        phase.count("nodes", image.size());
+    }
+    PhaseTimer phase(stats, "print");
+    if (options.json)
+    {
+        printFlatAstJson(image, out);
+        return true;
+    }
+    out << "Parser Output (Abstract Syntax Tree):\n";
+    for (size_t i = 0; i < image.statementCount(); i++)
+    {
+        printFlatAst(image, image.statements[i], out);
+    }
+    return true;
+}
+
+std::vector<BatchResult> compileBatch(const std::vector<std::string> &paths, const DriverOptions &options,
+                                      WorkStealingPool &pool)
+{
+    struct WorkerState
+    {
+        CompilerContext context;
+        CompileStats stats;
+        DriverOptions options;
+    };
+    std::vector<std::unique_ptr<WorkerState>> workers(pool.threadCount());
+    for (auto &worker : workers)
+    {
+        worker = std::make_unique<WorkerState>();
+        worker->options = options;
+        if (options.stats)
+            worker->options.stats = &worker->stats;
+    }
+
+    std::vector<BatchResult> results(paths.size());
+    pool.run(paths.size(), [&](size_t worker, size_t index)
+             {
+                 WorkerState &state = *workers[worker];
+                 std::ostringstream out;
+                 std::ostringstream errors;
+                 SourceFile source;
+                 BatchResult &result = results[index];
+                 bool opened;
+                 {
+                     PhaseTimer phase(state.options.stats, "read");
+                     opened = source.open(paths[index], errors);
+                     phase.count("bytes", source.text().size());
+                 }
+                 result.ok = opened && compileSource(source.text(), state.options, state.context, out, errors);
+                 result.output = out.str();
+                 result.errors = errors.str();
+             });
+    if (options.stats)
+    {
+        for (size_t worker = 0; worker < workers.size(); worker++)
+        {
+            options.stats->append(workers[worker]->stats, static_cast<uint32_t>(worker));
+        }
+    }
+    return results;
+}
+
+bool expandInputPaths(std::vector<std::string> &paths, std::ostream &errors)
+{
+    std::vector<std::string> expanded;
+    for (const std::string &path : paths)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error))
+        {
+            expanded.push_back(path);
+            continue;
+        }
+        std::vector<std::string> files;
+        for (std::filesystem::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error))
+        {
+            if (it->is_regular_file(error))
+                files.push_back(it->path().string());
+        }
+        if (error)
+        {
+            errors << "Error: Cannot list " << path << ": " << error.message() << "\n";
+            return false;
+        }
+        std::sort(files.begin(), files.end());
+        expanded.insert(expanded.end(), files.begin(), files.end());
+    }
+    paths = std::move(expanded);
+    return true;
+}
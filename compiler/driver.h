@@ -0,0 +1,77 @@
+#ifndef MINI_COMPILER_DRIVER_H
+#define MINI_COMPILER_DRIVER_H
+
+#include "cache.h"
+#include "context.h"
+#include "interner.h"
+#include "stats.h"
+#include "thread_pool.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What the driver does with each source text; the fields mirror main's options.
+struct DriverOptions
+{
+    bool flat = false;             // build and print a FlatAst; the tree passes below do not apply
+    bool parallel = false;         // parse statements, or lex an image's tokens, on all cores
+    bool check = false;            // fail on redeclared or undefined names (see SemanticAnalyzer)
+    bool fold = false;             // fold constant expressions before printing or running
+    bool run = false;              // run the bytecode and print variables instead of the AST
+    bool jit = false;              // like run, with native code where supported
+    bool json = false;             // print the AST as JSON lines (see printAstJson), without a header
+    CompileCache *cache = nullptr; // like run, reusing declarations compiled before
+    CompileStats *stats = nullptr; // records the time and counters of each phase
+    const char *image = nullptr;   // with flat, also writes the tokens and FlatAst to this parse image
+    const char *live = nullptr;    // comma-separated result variables; drops declarations they do not use
+};
+
+// Prints the value of every variable slot as "name = value" lines.
+void printVariables(const std::vector<int64_t> &variables, const std::vector<uint32_t> &slot_symbols,
+                    const Interner &interner, std::ostream &out);
+
+// Runs program on the VM and prints its variables, recording the "run" and "print" phases.
+bool runBytecode(const BytecodeProgram &program, const Interner &interner, CompileStats *stats, std::ostream &out,
+                 std::ostream &errors);
+
+// Parses one source text and prints its AST, or runs it and prints its variables, as
+// options ask. Nodes are allocated in arena and names interned in interner, so both
+// must outlive the call only as long as the caller needs them. Returns false on a
+// parse or arithmetic error, which is reported to errors. Each phase is recorded in
+// options.stats when it is set.
+bool compileSource(std::string_view code, const DriverOptions &options, Arena &arena, Interner &interner,
+                   std::ostream &out, std::ostream &errors);
+
+// Like compileSource above, in the arena and interner of context, which is reset first so
+// a process compiling many sources reuses their memory.
+bool compileSource(std::string_view code, const DriverOptions &options, CompilerContext &context, std::ostream &out,
+                   std::ostream &errors);
+
+// Prints the FlatAst stored in the parse image at path, as compileSource prints it with
+// options.flat, but without lexing or parsing. Only options.json and options.stats apply.
+// Records the "read" and "print" phases.
+bool printParseImage(const std::string &path, const DriverOptions &options, std::ostream &out, std::ostream &errors);
+
+// Output of one file compiled by compileBatch.
+struct BatchResult
+{
+    std::string output;
+    std::string errors;
+    bool ok = false;
+};
+
+// Compiles every file in paths on pool. Each worker reuses its own CompilerContext
+// from file to file, and results are returned in the order of paths however the work
+// was scheduled, so the output is deterministic. options.cache must be null, because
+// the cache is not shared between threads. With options.stats set, every worker records
+// its own phases, which are appended afterwards with the worker as the thread.
+std::vector<BatchResult> compileBatch(const std::vector<std::string> &paths, const DriverOptions &options,
+                                      WorkStealingPool &pool);
+
+// Replaces every directory in paths by the regular files below it, sorted by path so
+// batches over the same tree always run in the same order.
+bool expandInputPaths(std::vector<std::string> &paths, std::ostream &errors = std::cerr);
+
+#endif
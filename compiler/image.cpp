@@ -0,0 +1,248 @@
+#include "image.h"
+
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+namespace
+{
+
+constexpr size_t IMAGE_ALIGNMENT = 8;
+
+size_t alignUp(size_t size) { return (size + IMAGE_ALIGNMENT - 1) & ~(IMAGE_ALIGNMENT - 1); }
+
+// Appends text to the string table once, so repeated operators, literals and names
+// share one copy.
+class StringTableBuilder
+{
+public:
+    bool add(std::string_view text, ImageString &entry)
+    {
+        auto found = offsets.find(text);
+        if (found == offsets.end())
+        {
+            if (bytes.size() + text.size() > UINT32_MAX)
+                return false;
+            found = offsets.emplace(text, static_cast<uint32_t>(bytes.size())).first;
+            bytes.append(text);
+        }
+        entry = {found->second, static_cast<uint32_t>(text.size())};
+        return true;
+    }
+
+    std::string bytes;
+
+private:
+    std::unordered_map<std::string_view, uint32_t> offsets;
+};
+
+bool addTokens(const std::vector<Token> &tokens, StringTableBuilder &strings, std::vector<ImageToken> &out)
+{
+    out.reserve(tokens.size());
+    for (const Token &token : tokens)
+    {
+        ImageToken entry{static_cast<uint32_t>(token.type), token.symbol, {}, token.number};
+        if (!strings.add(token.value, entry.text))
+            return false;
+        out.push_back(entry);
+    }
+    return true;
+}
+
+// Appends count elements of data as the next section.
+template <typename T>
+void appendSection(std::string &image, ImageHeader &header, ImageSection section, const T *data, size_t count)
+{
+    image.resize(alignUp(image.size()));
+    header.sections[section] = {image.size(), count};
+    if (count > 0)
+        image.append(reinterpret_cast<const char *>(data), count * sizeof(T));
+}
+
+} // namespace
+
+bool buildParseImage(const std::vector<Token> &tokens, const FlatAst &ast, const std::vector<FlatNodeRef> &statements,
+                     const Interner &interner, std::string &image, std::ostream &errors)
+{
+    // Names go first, so identifier tokens find their text already in the table.
+    StringTableBuilder strings;
+    std::vector<ImageString> symbols(interner.size());
+    bool ok = true;
+    for (uint32_t symbol = 0; ok && symbol < symbols.size(); symbol++)
+    {
+        ok = strings.add(interner.name(symbol), symbols[symbol]);
+    }
+    std::vector<ImageToken> stream_tokens;
+    std::vector<ImageToken> ast_tokens;
+    ok = ok && addTokens(tokens, strings, stream_tokens) && addTokens(ast.tokens, strings, ast_tokens);
+    if (!ok || ast.size() > UINT32_MAX)
+    {
+        errors << "Error: Parse is too large for an image\n";
+        return false;
+    }
+    std::vector<uint32_t> roots;
+    roots.reserve(statements.size());
+    for (FlatNodeRef statement : statements)
+    {
+        roots.push_back(statement.index);
+    }
+
+    ImageHeader header{};
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = IMAGE_VERSION;
+    header.token_size = sizeof(ImageToken);
+    image.assign(sizeof(header), '\0');
+    appendSection(image, header, IMAGE_STREAM_TOKENS, stream_tokens.data(), stream_tokens.size());
+    appendSection(image, header, IMAGE_AST_TOKENS, ast_tokens.data(), ast_tokens.size());
+    appendSection(image, header, IMAGE_KINDS, ast.kinds.data(), ast.size());
+    appendSection(image, header, IMAGE_MAIN_TOKENS, ast.main_tokens.data(), ast.size());
+    appendSection(image, header, IMAGE_LHS, ast.lhs.data(), ast.size());
+    appendSection(image, header, IMAGE_RHS, ast.rhs.data(), ast.size());
+    appendSection(image, header, IMAGE_STATEMENTS, roots.data(), roots.size());
+    appendSection(image, header, IMAGE_SYMBOLS, symbols.data(), symbols.size());
+    appendSection(image, header, IMAGE_STRINGS, strings.bytes.data(), strings.bytes.size());
+    header.total_size = image.size();
+    std::memcpy(&image[0], &header, sizeof(header));
+    return true;
+}
+
+bool writeParseImage(const std::string &path, const std::vector<Token> &tokens, const FlatAst &ast,
+                     const std::vector<FlatNodeRef> &statements, const Interner &interner, std::ostream &errors)
+{
+    std::string image;
+    if (!buildParseImage(tokens, ast, statements, interner, image, errors))
+        return false;
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        errors << "Error: Cannot write " << path << "\n";
+        return false;
+    }
+    bool ok = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+        errors << "Error: Failed to write " << path << "\n";
+    return ok;
+}
+
+bool ParseImage::open(const std::string &path, std::ostream &errors)
+{
+    if (!file.open(path, errors))
+        return false;
+    if (view(file.text(), errors))
+        return true;
+    errors << "Error: " << path << " is not a valid parse image\n";
+    return false;
+}
+
+bool ParseImage::view(std::string_view bytes, std::ostream &errors)
+{
+    ImageHeader header;
+    if (bytes.size() < sizeof(header) || reinterpret_cast<uintptr_t>(bytes.data()) % IMAGE_ALIGNMENT != 0)
+    {
+        errors << "Error: Parse image is truncated or misaligned\n";
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 || header.version != IMAGE_VERSION ||
+        header.token_size != sizeof(ImageToken) || header.total_size != bytes.size())
+    {
+        errors << "Error: Parse image has the wrong format or version\n";
+        return false;
+    }
+
+    // Points pointer at a section, checking that it is aligned and inside the image.
+    bool ok = true;
+    size_t counts[IMAGE_SECTION_COUNT] = {};
+    auto section = [&](ImageSection index, const auto *&pointer)
+    {
+        const ImageHeader::Section &entry = header.sections[index];
+        if (entry.offset % IMAGE_ALIGNMENT != 0 || entry.offset > bytes.size() ||
+            entry.count > (bytes.size() - entry.offset) / sizeof(*pointer))
+        {
+            ok = false;
+            return;
+        }
+        pointer = reinterpret_cast<std::remove_reference_t<decltype(pointer)>>(bytes.data() + entry.offset);
+        counts[index] = static_cast<size_t>(entry.count);
+    };
+    const ImageToken *stream_entries = nullptr;
+    const ImageToken *ast_entries = nullptr;
+    section(IMAGE_STREAM_TOKENS, stream_entries);
+    section(IMAGE_AST_TOKENS, ast_entries);
+    section(IMAGE_KINDS, kinds);
+    section(IMAGE_MAIN_TOKENS, main_tokens);
+    section(IMAGE_LHS, lhs);
+    section(IMAGE_RHS, rhs);
+    section(IMAGE_STATEMENTS, statements);
+    section(IMAGE_SYMBOLS, symbols);
+    section(IMAGE_STRINGS, strings);
+    node_count = counts[IMAGE_KINDS];
+    statement_count = counts[IMAGE_STATEMENTS];
+    symbol_count = counts[IMAGE_SYMBOLS];
+    ok = ok && counts[IMAGE_MAIN_TOKENS] == node_count && counts[IMAGE_LHS] == node_count &&
+         counts[IMAGE_RHS] == node_count;
+
+    size_t string_bytes = counts[IMAGE_STRINGS];
+    auto validString = [&](const ImageString &text)
+    {
+        return text.offset <= string_bytes && text.size <= string_bytes - text.offset;
+    };
+    auto validTokens = [&](const ImageToken *entries, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const ImageToken &token = entries[i];
+            if (token.type > static_cast<uint32_t>(TokenType::UNKNOWN) || !validString(token.text) ||
+                (token.symbol != NO_SYMBOL && token.symbol >= symbol_count))
+                return false;
+        }
+        return true;
+    };
+    for (size_t symbol = 0; ok && symbol < symbol_count; symbol++)
+    {
+        ok = validString(symbols[symbol]);
+    }
+    ok = ok && validTokens(stream_entries, counts[IMAGE_STREAM_TOKENS]) &&
+         validTokens(ast_entries, counts[IMAGE_AST_TOKENS]);
+
+    // Children always precede their parents, which also rules out cycles.
+    size_t token_count = counts[IMAGE_AST_TOKENS];
+    for (uint32_t node = 0; ok && node < node_count; node++)
+    {
+        switch (kinds[node])
+        {
+        case NodeKind::NUMBER:
+        case NodeKind::VARIABLE:
+            ok = main_tokens[node] < token_count;
+            break;
+        case NodeKind::BINARY_OP:
+            ok = main_tokens[node] < token_count && lhs[node] < node && rhs[node] < node;
+            break;
+        case NodeKind::VAR_DECL:
+            ok = main_tokens[node] < token_count && lhs[node] < node && rhs[node] < token_count;
+            break;
+        default:
+            ok = false;
+            break;
+        }
+    }
+    for (size_t i = 0; ok && i < statement_count; i++)
+    {
+        ok = statements[i] < node_count && kinds[statements[i]] == NodeKind::VAR_DECL;
+    }
+    if (!ok)
+    {
+        errors << "Error: Parse image is damaged\n";
+        return false;
+    }
+
+    stream.entries = stream_entries;
+    stream.strings = strings;
+    stream.count = counts[IMAGE_STREAM_TOKENS];
+    tokens.entries = ast_entries;
+    tokens.strings = strings;
+    tokens.count = token_count;
+    return true;
+}
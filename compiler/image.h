@@ -0,0 +1,148 @@
+#ifndef MINI_COMPILER_IMAGE_H
+#define MINI_COMPILER_IMAGE_H
+
+#include "ast.h"
+#include "interner.h"
+#include "source_file.h"
+#include "token.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A parse image stores a token stream and a FlatAst in one relocation-free block. Every
+// link in it is an index or a byte offset, and all text lives in one string table, so a
+// file can be mapped and used in place with no deserialization. Identifier text is
+// shared with the symbol table, so each name is stored once. Values use native byte
+// order, so an image is only meant for the machine that wrote it.
+//
+// Layout: an ImageHeader, then the sections in ImageSection order. Each section starts
+// at an offset that is a multiple of 8.
+enum ImageSection
+{
+    IMAGE_STREAM_TOKENS, // ImageToken for each token of the lexed input, END_OF_FILE excluded
+    IMAGE_AST_TOKENS,    // ImageToken for each entry of FlatAst::tokens
+    IMAGE_KINDS,         // NodeKind for each node
+    IMAGE_MAIN_TOKENS,   // uint32_t for each node, as in FlatAst
+    IMAGE_LHS,           // uint32_t for each node
+    IMAGE_RHS,           // uint32_t for each node
+    IMAGE_STATEMENTS,    // uint32_t root node of each statement
+    IMAGE_SYMBOLS,       // ImageString with the name of each symbol ID
+    IMAGE_STRINGS,       // bytes of all token text and names
+    IMAGE_SECTION_COUNT
+};
+
+struct ImageString
+{
+    uint32_t offset; // into IMAGE_STRINGS
+    uint32_t size;
+};
+
+struct ImageToken
+{
+    uint32_t type;   // TokenType
+    uint32_t symbol; // index into IMAGE_SYMBOLS, or NO_SYMBOL
+    ImageString text;
+    int64_t number;
+};
+
+struct ImageHeader
+{
+    struct Section
+    {
+        uint64_t offset; // from the start of the image
+        uint64_t count;  // elements, or bytes for IMAGE_STRINGS
+    };
+
+    char magic[8];
+    uint32_t version;
+    uint32_t token_size; // sizeof(ImageToken), which catches layout mismatches
+    uint64_t total_size;
+    Section sections[IMAGE_SECTION_COUNT];
+};
+
+constexpr char IMAGE_MAGIC[8] = {'M', 'C', 'I', 'M', 'A', 'G', 'E', '\0'};
+constexpr uint32_t IMAGE_VERSION = 1;
+
+// Builds the image of tokens and of ast with its statements. Symbol IDs are those of
+// interner. Returns false if the text does not fit in 32-bit offsets.
+bool buildParseImage(const std::vector<Token> &tokens, const FlatAst &ast, const std::vector<FlatNodeRef> &statements,
+                     const Interner &interner, std::string &image, std::ostream &errors = std::cerr);
+
+// Builds the image and writes it to path in a single write.
+bool writeParseImage(const std::string &path, const std::vector<Token> &tokens, const FlatAst &ast,
+                     const std::vector<FlatNodeRef> &statements, const Interner &interner,
+                     std::ostream &errors = std::cerr);
+
+// Read-only view of a parse image. Its members mirror FlatAst closely enough for code
+// written against FlatAst (as printFlatAst is, through a template) to run on an image
+// directly. Tokens are decoded on access into Tokens that view the string table.
+class ParseImage
+{
+public:
+    // Indexable table of ImageTokens.
+    class TokenTable
+    {
+    public:
+        Token operator[](size_t index) const
+        {
+            const ImageToken &token = entries[index];
+            return Token(static_cast<TokenType>(token.type), std::string_view(strings + token.text.offset, token.text.size),
+                         token.symbol, token.number);
+        }
+        size_t size() const { return count; }
+
+    private:
+        friend class ParseImage;
+        const ImageToken *entries = nullptr;
+        const char *strings = nullptr;
+        size_t count = 0;
+    };
+
+    ParseImage() = default;
+    ParseImage(const ParseImage &) = delete;
+    ParseImage &operator=(const ParseImage &) = delete;
+
+    // Maps the image file at path and checks it as view() does.
+    bool open(const std::string &path, std::ostream &errors = std::cerr);
+
+    // Uses the image held in bytes, which must stay valid and 8-byte aligned while the
+    // view is used. Every offset and link is checked once, so a damaged image is
+    // rejected here instead of being read out of bounds later. Returns false if the
+    // image is damaged, truncated or from another version.
+    bool view(std::string_view bytes, std::ostream &errors = std::cerr);
+
+    size_t size() const { return node_count; }
+    size_t statementCount() const { return statement_count; }
+    size_t symbolCount() const { return symbol_count; }
+
+    int64_t numberValue(uint32_t node) const
+    {
+        return static_cast<int64_t>(static_cast<uint64_t>(rhs[node]) << 32 | lhs[node]);
+    }
+
+    std::string_view symbolName(uint32_t symbol) const
+    {
+        return std::string_view(strings + symbols[symbol].offset, symbols[symbol].size);
+    }
+
+    TokenTable stream; // the lexed token stream
+    TokenTable tokens; // FlatAst::tokens
+    const NodeKind *kinds = nullptr;
+    const uint32_t *main_tokens = nullptr;
+    const uint32_t *lhs = nullptr;
+    const uint32_t *rhs = nullptr;
+    const uint32_t *statements = nullptr; // root node of each statement
+
+private:
+    SourceFile file;
+    const ImageString *symbols = nullptr;
+    const char *strings = nullptr;
+    size_t node_count = 0;
+    size_t statement_count = 0;
+    size_t symbol_count = 0;
+};
+
+#endif
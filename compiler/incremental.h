@@ -0,0 +1,270 @@
+#ifndef MINI_COMPILER_INCREMENTAL_H
+#define MINI_COMPILER_INCREMENTAL_H
+
+#include "parser.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Keeps a program parsed while it is being edited. The source is held as a sequence of
+// segments, each running up to and including one ';' (only the last may be unterminated),
+// and every segment owns its text, its parsed statement and the Arena holding its nodes.
+// An edit re-lexes and re-parses only the segments it touches, extended to the next ';'
+// so the lexer resynchronizes at a statement boundary, as in splitAtStatementBoundaries;
+// all other VarDeclNode subtrees are reused untouched. Segments sit in a treap ordered
+// by position, so locating an edit costs O(log n) and its latency depends on the size of
+// the changed statements rather than of the file.
+//
+// Symbols are interned into the given Interner and stay stable across edits, so IDs
+// follow first appearance over the document's history rather than source order.
+class IncrementalParser
+{
+public:
+    // What one open() or edit() had to redo.
+    struct EditStats
+    {
+        bool ok = true;               // false if the edit range was outside the document
+        size_t relexed_bytes = 0;     // bytes of source lexed again
+        size_t reparsed_segments = 0; // segments lexed and parsed again
+    };
+
+    explicit IncrementalParser(Interner &interner) : interner(interner) {}
+
+    // Replaces the whole document and parses it from scratch.
+    EditStats open(std::string_view source)
+    {
+        EditStats stats;
+        root.reset();
+        root = buildSegments(std::string(source), stats);
+        return stats;
+    }
+
+    // Replaces the removed bytes starting at offset with inserted. A range outside the
+    // document leaves it unchanged and returns stats with ok false.
+    EditStats edit(size_t offset, size_t removed, std::string_view inserted)
+    {
+        EditStats stats;
+        size_t length = size();
+        if (offset > length || removed > length - offset)
+        {
+            stats.ok = false;
+            return stats;
+        }
+        size_t from = offset;
+        size_t to = offset + removed;
+
+        // Segments wholly before the edit. One that ends exactly at the edit stays, unless
+        // it is the unterminated tail of the document, which the inserted text extends.
+        auto [before, rest] = split(std::move(root), 0, [&](size_t start, const Segment &segment)
+                                    {
+                                        size_t end = start + segment.text.size();
+                                        return end < from || (end == from && terminated(segment));
+                                    });
+        size_t touched_start = bytes(before);
+        auto [touched, after] = split(std::move(rest), touched_start, [&](size_t start, const Segment &)
+                                      { return start < std::max(to, from + 1); });
+
+        std::string text;
+        appendText(touched.get(), text);
+        text.replace(from - touched_start, removed, inserted);
+        touched.reset();
+
+        // Until the text ends in ';' the next segment's tokens may have changed too.
+        while (!text.empty() && text.back() != ';' && after)
+        {
+            auto [first, remainder] = split(std::move(after), 0, [](size_t start, const Segment &)
+                                            { return start == 0; });
+            text += first->text;
+            after = std::move(remainder);
+        }
+
+        root = merge(merge(std::move(before), buildSegments(std::move(text), stats)), std::move(after));
+        return stats;
+    }
+
+    size_t size() const { return bytes(root); }
+    size_t statementCount() const { return root ? root->total_statements : 0; }
+    bool ok() const { return !root || root->total_failures == 0; }
+
+    // Returns the current source text.
+    std::string text() const
+    {
+        std::string out;
+        appendText(root.get(), out);
+        return out;
+    }
+
+    // Appends the statements that parsed, in source order. Like a serial parse, returns
+    // false if any segment failed.
+    bool statements(std::vector<AstNode *> &out) const
+    {
+        forEachSegment(root.get(), [&](const Segment &segment)
+                       {
+                           if (segment.statement)
+                               out.push_back(segment.statement);
+                           return true;
+                       });
+        return ok();
+    }
+
+    // Prints the errors of every segment, with lines and columns counted over the whole
+    // document, as a serial parse would.
+    void reportErrors(std::ostream &out = std::cerr) const
+    {
+        if (ok())
+            return;
+        std::string document = text();
+        Diagnostics diagnostics(document);
+        size_t start = 0;
+        forEachSegment(root.get(), [&](const Segment &segment)
+                       {
+                           diagnostics.append(segment.diagnostics, start);
+                           start += segment.text.size();
+                           return true;
+                       });
+        diagnostics.print(out);
+    }
+
+private:
+    struct Segment
+    {
+        std::string text; // views into this are held by the tokens of statement
+        Arena arena;
+        AstNode *statement = nullptr;
+        Diagnostics diagnostics; // offsets are from the start of text
+        bool failed = false;
+
+        uint64_t priority;
+        std::unique_ptr<Segment> left;
+        std::unique_ptr<Segment> right;
+        size_t total_bytes = 0; // totals over this subtree of the treap
+        size_t total_statements = 0;
+        size_t total_failures = 0;
+
+        Segment(std::string text, uint64_t priority)
+            : text(std::move(text)), arena(std::max<size_t>(256, this->text.size() * 16)), priority(priority) {}
+    };
+    using SegmentPtr = std::unique_ptr<Segment>;
+
+    Interner &interner;
+    SegmentPtr root;
+    uint64_t segments_created = 0;
+
+    static bool terminated(const Segment &segment) { return segment.text.back() == ';'; }
+    static size_t bytes(const SegmentPtr &node) { return node ? node->total_bytes : 0; }
+
+    static void update(Segment &node)
+    {
+        node.total_bytes = node.text.size();
+        node.total_statements = node.statement ? 1 : 0;
+        node.total_failures = node.failed ? 1 : 0;
+        for (const SegmentPtr *child : {&node.left, &node.right})
+        {
+            if (*child)
+            {
+                node.total_bytes += (*child)->total_bytes;
+                node.total_statements += (*child)->total_statements;
+                node.total_failures += (*child)->total_failures;
+            }
+        }
+    }
+
+    // Splits t, whose first byte is at offset start, into the leading segments for which
+    // goes_left(segment start, segment) holds and the rest. goes_left must be true for a
+    // prefix of the segments and false afterwards.
+    template <typename Predicate>
+    static std::pair<SegmentPtr, SegmentPtr> split(SegmentPtr t, size_t start, const Predicate &goes_left)
+    {
+        if (!t)
+            return {};
+        size_t node_start = start + bytes(t->left);
+        if (goes_left(node_start, *t))
+        {
+            auto [left, right] = split(std::move(t->right), node_start + t->text.size(), goes_left);
+            t->right = std::move(left);
+            update(*t);
+            return {std::move(t), std::move(right)};
+        }
+        auto [left, right] = split(std::move(t->left), start, goes_left);
+        t->left = std::move(right);
+        update(*t);
+        return {std::move(left), std::move(t)};
+    }
+
+    static SegmentPtr merge(SegmentPtr a, SegmentPtr b)
+    {
+        if (!a)
+            return b;
+        if (!b)
+            return a;
+        if (a->priority > b->priority)
+        {
+            a->right = merge(std::move(a->right), std::move(b));
+            update(*a);
+            return a;
+        }
+        b->left = merge(std::move(a), std::move(b->left));
+        update(*b);
+        return b;
+    }
+
+    // Visits segments in source order until visit returns false; returns false if it did.
+    template <typename Visit>
+    static bool forEachSegment(const Segment *node, const Visit &visit)
+    {
+        std::vector<const Segment *> stack;
+        while (node || !stack.empty())
+        {
+            for (; node; node = node->left.get())
+            {
+                stack.push_back(node);
+            }
+            node = stack.back();
+            stack.pop_back();
+            if (!visit(*node))
+                return false;
+            node = node->right.get();
+        }
+        return true;
+    }
+
+    static void appendText(const Segment *node, std::string &out)
+    {
+        forEachSegment(node, [&](const Segment &segment)
+                       {
+                           out += segment.text;
+                           return true;
+                       });
+    }
+
+    // Cuts text after every ';' and parses each piece into its own segment.
+    SegmentPtr buildSegments(std::string text, EditStats &stats)
+    {
+        stats.relexed_bytes += text.size();
+        SegmentPtr built;
+        for (size_t start = 0; start < text.size();)
+        {
+            size_t end = std::min(text.find(';', start), text.size() - 1) + 1;
+            auto segment = std::make_unique<Segment>(text.substr(start, end - start), mixHash(++segments_created));
+            parseSegment(*segment);
+            stats.reparsed_segments++;
+            built = merge(std::move(built), std::move(segment));
+            start = end;
+        }
+        return built;
+    }
+
+    void parseSegment(Segment &segment)
+    {
+        segment.diagnostics = Diagnostics(segment.text);
+        Lexer lexer(segment.text, interner);
+        Parser parser(lexer, segment.arena, segment.diagnostics);
+        std::vector<AstNode *> statements;
+        segment.failed = !parser.parseProgram(statements);
+        segment.statement = statements.empty() ? nullptr : statements.front();
+        update(segment);
+    }
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef MINI_COMPILER_INTERNER_H
+#define MINI_COMPILER_INTERNER_H
+
+#include "arena.h"
+#include "token.h"
+
+#include <cstring>
+
+// Fast 64-bit hash for short byte strings: eight bytes per step with multiply-xorshift
+// mixing, in the spirit of wyhash.
+inline uint64_t mixHash(uint64_t x)
+{
+    x ^= x >> 32;
+    x *= 0x9E3779B97F4A7C15ull;
+    x ^= x >> 29;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 32;
+    return x;
+}
+
+inline uint64_t hashBytes(const char *data, size_t size, uint64_t seed = 0)
+{
+    uint64_t hash = seed ^ (size * 0x9E3779B97F4A7C15ull);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = mixHash(hash ^ word);
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, size - i);
+    return mixHash(hash ^ tail);
+}
+
+// Maps each distinct identifier to a dense 32-bit symbol ID, assigned in order of first
+// appearance. Names are copied into an Arena once, so symbols do not depend on the source
+// buffer and repeated names cost nothing. Lookups use an open-addressed table with linear
+// probing that stores symbol + 1 per slot (0 marks an empty slot).
+class Interner
+{
+public:
+    Interner() : slots(64, 0) {}
+    Interner(const Interner &) = delete;
+    Interner &operator=(const Interner &) = delete;
+
+    uint32_t intern(std::string_view name)
+    {
+        uint64_t hash = hashBytes(name.data(), name.size());
+        size_t slot = findSlot(name, hash);
+        if (slots[slot] != 0)
+            return slots[slot] - 1;
+
+        char *copy = static_cast<char *>(storage.allocate(name.size(), 1));
+        std::memcpy(copy, name.data(), name.size());
+        uint32_t symbol = static_cast<uint32_t>(entries.size());
+        entries.push_back({std::string_view(copy, name.size()), hash});
+        slots[slot] = symbol + 1;
+        if (entries.size() * 2 > slots.size())
+            grow();
+        return symbol;
+    }
+
+    // Returns the symbol for name, or NO_SYMBOL if it was never interned.
+    uint32_t find(std::string_view name) const
+    {
+        uint32_t stored = slots[findSlot(name, hashBytes(name.data(), name.size()))];
+        return stored == 0 ? NO_SYMBOL : stored - 1;
+    }
+
+    std::string_view name(uint32_t symbol) const { return entries[symbol].name; }
+    size_t size() const { return entries.size(); }
+
+    // Forgets every symbol but keeps the table and name storage for reuse. A table that
+    // grew for one large input and is now mostly empty is cleared slot by slot, so reuse
+    // costs time proportional to the symbols rather than the table.
+    void clear()
+    {
+        if (entries.size() * 4 < slots.size())
+        {
+            // Locate every slot before zeroing any, since zeroing breaks probe chains.
+            for (Entry &entry : entries)
+                entry.hash = findSlot(entry.name, entry.hash);
+            for (const Entry &entry : entries)
+                slots[entry.hash] = 0;
+        }
+        else
+        {
+            std::fill(slots.begin(), slots.end(), 0);
+        }
+        entries.clear();
+        storage.reset();
+    }
+
+private:
+    struct Entry
+    {
+        std::string_view name;
+        uint64_t hash;
+    };
+
+    Arena storage;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> slots; // size is a power of two
+
+    size_t findSlot(std::string_view name, uint64_t hash) const
+    {
+        size_t mask = slots.size() - 1;
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+        {
+            uint32_t stored = slots[slot];
+            if (stored == 0)
+                return slot;
+            const Entry &entry = entries[stored - 1];
+            if (entry.hash == hash && entry.name == name)
+                return slot;
+        }
+    }
+
+    void grow()
+    {
+        std::vector<uint32_t> old_slots(slots.size() * 2, 0);
+        old_slots.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (uint32_t stored : old_slots)
+        {
+            if (stored == 0)
+                continue;
+            size_t slot = entries[stored - 1].hash & mask;
+            while (slots[slot] != 0)
+                slot = (slot + 1) & mask;
+            slots[slot] = stored;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,312 @@
+#include "jit.h"
+
+#include <cstring>
+
+#ifdef MINI_COMPILER_HAS_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+bool JitProgram::compile(const std::vector<AstNode *> &statements)
+{
+    release();
+    entries.clear();
+    slots.clear();
+    code.clear();
+    for (const AstNode *statement : statements)
+    {
+        auto decl = nodeAs<VarDeclNode>(statement);
+        Entry entry{decl->expression, slots.slotFor(decl->identifier.symbol), code.size(), false};
+#ifdef MINI_COMPILER_HAS_JIT
+        entry.native = emitFunction(decl->expression);
+#endif
+        if (!entry.native)
+            numberSlots(decl->expression);
+        entries.push_back(entry);
+    }
+    native_count = 0;
+    for (const Entry &entry : entries)
+    {
+        native_count += entry.native;
+    }
+    return native_count > 0 && mapCode();
+}
+
+ArithStatus JitProgram::run(std::vector<int64_t> &variables, size_t &failed_statement)
+{
+    variables.assign(slots.symbols().size(), 0);
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const Entry &entry = entries[i];
+        int64_t value;
+        ArithStatus status;
+        if (entry.native && memory)
+        {
+            auto function = reinterpret_cast<JitFunction>(static_cast<uint8_t *>(memory) + entry.offset);
+            status = static_cast<ArithStatus>(function(variables.data(), &value));
+        }
+        else
+        {
+            status = fallback.evaluate(entry.expression, value,
+                                       [&](uint32_t symbol) { return variables[slots.slotOf(symbol)]; });
+        }
+        if (status != ArithStatus::OK)
+        {
+            failed_statement = i;
+            return status;
+        }
+        variables[entry.slot] = value;
+    }
+    return ArithStatus::OK;
+}
+
+void JitProgram::numberSlots(const AstNode *root)
+{
+    // Same left-to-right order as emitFunction(), so the slots do not depend on which
+    // expressions were compiled natively.
+    std::vector<const AstNode *> stack{root};
+    while (!stack.empty())
+    {
+        const AstNode *node = stack.back();
+        stack.pop_back();
+        if (auto variable = nodeAs<VariableNode>(node))
+        {
+            slots.slotFor(variable->identifier.symbol);
+        }
+        else if (auto p = nodeAs<BinaryOpNode>(node))
+        {
+            stack.push_back(p->right);
+            stack.push_back(p->left);
+        }
+    }
+}
+
+void JitProgram::release()
+{
+#ifdef MINI_COMPILER_HAS_JIT
+    if (memory)
+        munmap(memory, memory_size);
+#endif
+    memory = nullptr;
+    memory_size = 0;
+}
+
+#ifdef MINI_COMPILER_HAS_JIT
+bool JitProgram::mapCode()
+{
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (code.size() + page - 1) / page * page;
+    void *pages = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED)
+        return false;
+    std::memcpy(pages, code.data(), code.size());
+    if (mprotect(pages, size, PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(pages, size);
+        return false;
+    }
+    memory = pages;
+    memory_size = size;
+    return true;
+}
+
+void JitProgram::emitBytes(std::initializer_list<uint8_t> bytes)
+{
+    code.insert(code.end(), bytes);
+}
+
+template <typename T>
+void JitProgram::emitImmediate(T value)
+{
+    size_t at = code.size();
+    code.resize(at + sizeof(T));
+    std::memcpy(code.data() + at, &value, sizeof(T));
+}
+
+void JitProgram::emitJumpTarget(std::vector<size_t> &fixups)
+{
+    fixups.push_back(code.size());
+    emitImmediate<int32_t>(0);
+}
+
+void JitProgram::patchJumps(const std::vector<size_t> &fixups, size_t target)
+{
+    for (size_t at : fixups)
+    {
+        int32_t rel = static_cast<int32_t>(target - (at + 4));
+        std::memcpy(code.data() + at, &rel, sizeof(rel));
+    }
+}
+
+void JitProgram::emitMoveImmediate(uint8_t dst, int64_t value)
+{
+    if (value >= INT32_MIN && value <= INT32_MAX)
+    {
+        emitBytes({0x48, 0xC7, dst}); // mov r64, imm32 (sign-extended)
+        emitImmediate(static_cast<int32_t>(value));
+    }
+    else
+    {
+        emitBytes({0x48, static_cast<uint8_t>(0xB8 + (dst - 0xC0))}); // movabs r64, imm64
+        emitImmediate(value);
+    }
+}
+
+bool JitProgram::emitVariableOperand(std::initializer_list<uint8_t> opcode, const VariableNode *variable)
+{
+    uint64_t offset = uint64_t(slots.slotFor(variable->identifier.symbol)) * sizeof(int64_t);
+    if (offset > INT32_MAX)
+        return false;
+    emitBytes(opcode);
+    emitImmediate(static_cast<int32_t>(offset));
+    return true;
+}
+
+bool JitProgram::emitFunction(const AstNode *root)
+{
+    size_t start = code.size();
+    std::vector<size_t> overflow_jumps;
+    std::vector<size_t> divide_jumps;
+    std::vector<std::pair<const AstNode *, bool>> stack{{root, false}};
+    size_t live = 0; // operand values held in rax plus the machine stack
+
+    emitBytes({0x55, 0x48, 0x89, 0xE5}); // push rbp; mov rbp, rsp
+    while (!stack.empty())
+    {
+        auto [node, children_done] = stack.back();
+        stack.pop_back();
+        if (node->kind != NodeKind::BINARY_OP)
+        {
+            if (live > 0)
+                emitBytes({0x50}); // push rax
+            bool ok = ++live <= MAX_DEPTH;
+            if (ok && node->kind == NodeKind::VARIABLE) // mov rax, [rdi + disp32]
+                ok = emitVariableOperand({0x48, 0x8B, 0x87}, static_cast<const VariableNode *>(node));
+            else if (ok)
+                emitMoveImmediate(0xC0, static_cast<const NumberNode *>(node)->value);
+            if (!ok)
+            {
+                code.resize(start);
+                return false;
+            }
+            continue;
+        }
+
+        auto p = static_cast<const BinaryOpNode *>(node);
+        auto literal_right = nodeAs<NumberNode>(p->right);
+        auto variable_right = nodeAs<VariableNode>(p->right);
+        if (!children_done)
+        {
+            stack.push_back({p, true});
+            if (!literal_right && !variable_right)
+                stack.push_back({p->right, false});
+            stack.push_back({p->left, false});
+            continue;
+        }
+        if (literal_right && p->op.type != TokenType::OPERATOR_DIVIDE && literal_right->value >= INT32_MIN &&
+            literal_right->value <= INT32_MAX)
+        {
+            switch (p->op.type)
+            {
+            case TokenType::OPERATOR_PLUS:
+                emitBytes({0x48, 0x05}); // add rax, imm32
+                break;
+            case TokenType::OPERATOR_MINUS:
+                emitBytes({0x48, 0x2D}); // sub rax, imm32
+                break;
+            default:
+                emitBytes({0x48, 0x69, 0xC0}); // imul rax, rax, imm32
+                break;
+            }
+            emitImmediate(static_cast<int32_t>(literal_right->value));
+            emitBytes({0x0F, 0x80}); // jo overflow
+            emitJumpTarget(overflow_jumps);
+            continue;
+        }
+        if (variable_right && p->op.type != TokenType::OPERATOR_DIVIDE)
+        {
+            // The variable is used as a memory operand; the encodings differ only in opcode.
+            bool ok;
+            switch (p->op.type)
+            {
+            case TokenType::OPERATOR_PLUS:
+                ok = emitVariableOperand({0x48, 0x03, 0x87}, variable_right); // add rax, [rdi + disp32]
+                break;
+            case TokenType::OPERATOR_MINUS:
+                ok = emitVariableOperand({0x48, 0x2B, 0x87}, variable_right); // sub rax, [rdi + disp32]
+                break;
+            default:
+                ok = emitVariableOperand({0x48, 0x0F, 0xAF, 0x87}, variable_right); // imul rax, [rdi + disp32]
+                break;
+            }
+            if (!ok)
+            {
+                code.resize(start);
+                return false;
+            }
+            emitBytes({0x0F, 0x80}); // jo overflow
+            emitJumpTarget(overflow_jumps);
+            continue;
+        }
+        if (literal_right)
+        {
+            emitMoveImmediate(0xC1, literal_right->value);
+        }
+        else if (variable_right)
+        {
+            if (!emitVariableOperand({0x48, 0x8B, 0x8F}, variable_right)) // mov rcx, [rdi + disp32]
+            {
+                code.resize(start);
+                return false;
+            }
+        }
+        else
+        {
+            emitBytes({0x48, 0x89, 0xC1, 0x58}); // mov rcx, rax; pop rax
+            live--;
+        }
+        switch (p->op.type)
+        {
+        case TokenType::OPERATOR_PLUS:
+            emitBytes({0x48, 0x01, 0xC8}); // add rax, rcx
+            break;
+        case TokenType::OPERATOR_MINUS:
+            emitBytes({0x48, 0x29, 0xC8}); // sub rax, rcx
+            break;
+        case TokenType::OPERATOR_MULTIPLY:
+            emitBytes({0x48, 0x0F, 0xAF, 0xC1}); // imul rax, rcx
+            break;
+        default:
+            emitBytes({0x48, 0x85, 0xC9, 0x0F, 0x84}); // test rcx, rcx; jz divide_by_zero
+            emitJumpTarget(divide_jumps);
+            // x / -1 is computed as -x, because idiv faults on INT64_MIN / -1.
+            emitBytes({0x48, 0x83, 0xF9, 0xFF, 0x75, 0x0B}); // cmp rcx, -1; jne divide
+            emitBytes({0x48, 0xF7, 0xD8, 0x0F, 0x80});       // neg rax; jo overflow
+            emitJumpTarget(overflow_jumps);
+            emitBytes({0xEB, 0x05});                         // jmp done
+            emitBytes({0x48, 0x99, 0x48, 0xF7, 0xF9});       // divide: cqo; idiv rcx
+            continue;                                        // done:
+        }
+        emitBytes({0x0F, 0x80}); // jo overflow
+        emitJumpTarget(overflow_jumps);
+    }
+    emitBytes({0x48, 0x89, 0x06});       // mov [rsi], rax
+    emitBytes({0x31, 0xC0, 0x5D, 0xC3}); // xor eax, eax; pop rbp; ret
+
+    // Failure exits discard the pending operands by restoring rsp from rbp.
+    patchJumps(overflow_jumps, code.size());
+    emitBytes({0xB8});
+    emitImmediate<int32_t>(static_cast<int32_t>(ArithStatus::INTEGER_OVERFLOW));
+    emitBytes({0x48, 0x89, 0xEC, 0x5D, 0xC3}); // mov rsp, rbp; pop rbp; ret
+    patchJumps(divide_jumps, code.size());
+    emitBytes({0xB8});
+    emitImmediate<int32_t>(static_cast<int32_t>(ArithStatus::DIVISION_BY_ZERO));
+    emitBytes({0x48, 0x89, 0xEC, 0x5D, 0xC3});
+    return true;
+}
+#else
+bool JitProgram::mapCode()
+{
+    return false;
+}
+#endif
@@ -0,0 +1,113 @@
+#ifndef MINI_COMPILER_JIT_H
+#define MINI_COMPILER_JIT_H
+
+#include "bytecode.h"
+#include "passes.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#if defined(__x86_64__) && !defined(_WIN32) && !defined(MINI_COMPILER_NO_JIT)
+#define MINI_COMPILER_HAS_JIT
+#endif
+
+// Signature of a JIT-compiled expression (System V x86-64 ABI). It reads variables by
+// slot, stores the value in *result and returns 0, or returns the ArithStatus of the
+// first failing operation.
+using JitFunction = int (*)(const int64_t *variables, int64_t *result);
+
+static_assert(static_cast<int>(ArithStatus::OK) == 0 && static_cast<int>(ArithStatus::INTEGER_OVERFLOW) == 1 &&
+                  static_cast<int>(ArithStatus::DIVISION_BY_ZERO) == 2,
+              "JIT code returns ArithStatus values directly");
+
+// Compiles the expression of every declaration straight from its tree to x86-64 machine
+// code in one executable mapping (mmap, then mprotect to read+execute). Each expression
+// becomes one function that checks every operation like the other evaluators.
+// Expressions deeper than MAX_DEPTH, and every expression on platforms without JIT
+// support, are evaluated with TreeEvaluator instead, so run() always produces the same
+// values as the VM.
+class JitProgram
+{
+public:
+    static constexpr size_t MAX_DEPTH = 4096; // live operand values per expression
+
+    JitProgram() = default;
+    JitProgram(const JitProgram &) = delete;
+    JitProgram &operator=(const JitProgram &) = delete;
+    ~JitProgram() { release(); }
+
+    static constexpr bool supported()
+    {
+#ifdef MINI_COMPILER_HAS_JIT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Compiles statements. Returns false if no native code could be generated, in which
+    // case run() interprets everything.
+    bool compile(const std::vector<AstNode *> &statements);
+
+    // Runs every declaration in order and stores the values in variables, indexed by slot.
+    // variables starts out all 0, as in VirtualMachine::run, whatever it held before. On
+    // failure returns the status and the index of the failing statement.
+    ArithStatus run(std::vector<int64_t> &variables, size_t &failed_statement);
+
+    size_t nativeCount() const { return memory ? native_count : 0; }
+    const std::vector<uint32_t> &slotSymbols() const { return slots.symbols(); }
+
+private:
+    struct Entry
+    {
+        const AstNode *expression;
+        uint32_t slot;
+        size_t offset; // start of the function in code
+        bool native;
+    };
+
+    std::vector<Entry> entries;
+    SlotAllocator slots;
+    std::vector<uint8_t> code;
+    size_t native_count = 0;
+    void *memory = nullptr;
+    size_t memory_size = 0;
+    TreeEvaluator fallback;
+
+    void release();
+    bool mapCode();
+
+    // Numbers the variables root reads, for an expression that is not compiled natively.
+    void numberSlots(const AstNode *root);
+
+#ifdef MINI_COMPILER_HAS_JIT
+    void emitBytes(std::initializer_list<uint8_t> bytes);
+
+    template <typename T>
+    void emitImmediate(T value);
+
+    // Emits the rel32 field of a jump and records it for patching.
+    void emitJumpTarget(std::vector<size_t> &fixups);
+
+    void patchJumps(const std::vector<size_t> &fixups, size_t target);
+
+    // Loads value into rax (dst = 0xC0) or rcx (dst = 0xC1).
+    void emitMoveImmediate(uint8_t dst, int64_t value);
+
+    // Emits an instruction whose ModRM byte ends opcode and addresses [rdi + disp32],
+    // with the offset of variable's slot as the displacement. Returns false if the
+    // offset does not fit in 32 bits.
+    bool emitVariableOperand(std::initializer_list<uint8_t> opcode, const VariableNode *variable);
+
+    // Appends one function for root. The value on top of the operand stack is kept in
+    // rax and the rest live on the machine stack; a literal right operand becomes an
+    // immediate (or is loaded into rcx) and a variable one a memory operand, so
+    // left-leaning chains never touch the machine stack.
+    // Returns false and discards the partial code if root is deeper than MAX_DEPTH or
+    // reads a slot beyond a 32-bit displacement.
+    bool emitFunction(const AstNode *root);
+#endif
+};
+
+#endif
@@ -0,0 +1,394 @@
+#ifndef MINI_COMPILER_LEXER_H
+#define MINI_COMPILER_LEXER_H
+
+#include "interner.h"
+#include "token.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Reserved words of the language. The lexer recognizes them with a perfect hash on
+// (length, first byte, last byte) computed from the raw span, so adding keywords does
+// not slow down the identifier path. A static_assert rejects tables that collide.
+struct Keyword
+{
+    std::string_view text;
+    TokenType type;
+};
+
+constexpr Keyword KEYWORDS[] = {
+    {"int", TokenType::KEYWORD_INT},
+    {"if", TokenType::KEYWORD_IF},
+    {"while", TokenType::KEYWORD_WHILE},
+    {"return", TokenType::KEYWORD_RETURN},
+};
+
+constexpr size_t KEYWORD_SLOTS = 16; // power of two
+
+constexpr size_t keywordSlot(size_t length, char first, char last)
+{
+    return (length * 7 + static_cast<unsigned char>(first) * 3 + static_cast<unsigned char>(last)) & (KEYWORD_SLOTS - 1);
+}
+
+struct KeywordTable
+{
+    int8_t slots[KEYWORD_SLOTS]; // index into KEYWORDS, or -1
+    size_t min_length;
+    size_t max_length;
+    bool perfect;
+};
+
+constexpr KeywordTable buildKeywordTable()
+{
+    KeywordTable table{};
+    for (size_t i = 0; i < KEYWORD_SLOTS; i++)
+    {
+        table.slots[i] = -1;
+    }
+    table.min_length = SIZE_MAX;
+    table.perfect = true;
+    for (size_t i = 0; i < sizeof(KEYWORDS) / sizeof(KEYWORDS[0]); i++)
+    {
+        std::string_view text = KEYWORDS[i].text;
+        size_t slot = keywordSlot(text.size(), text.front(), text.back());
+        if (table.slots[slot] != -1)
+            table.perfect = false;
+        table.slots[slot] = static_cast<int8_t>(i);
+        table.min_length = std::min(table.min_length, text.size());
+        table.max_length = std::max(table.max_length, text.size());
+    }
+    return table;
+}
+
+constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+static_assert(KEYWORD_TABLE.perfect, "keyword hash collides; adjust keywordSlot or KEYWORD_SLOTS");
+
+// Returns the keyword type of text, or IDENTIFIER if text is not a keyword.
+inline TokenType lookupKeyword(std::string_view text)
+{
+    if (text.size() < KEYWORD_TABLE.min_length || text.size() > KEYWORD_TABLE.max_length)
+        return TokenType::IDENTIFIER;
+    int8_t index = KEYWORD_TABLE.slots[keywordSlot(text.size(), text.front(), text.back())];
+    if (index >= 0 && KEYWORDS[index].text == text)
+        return KEYWORDS[index].type;
+    return TokenType::IDENTIFIER;
+}
+
+// Character classes used by the lexer, one bit per class.
+enum CharClass : uint8_t
+{
+    CHAR_SPACE = 1 << 0,
+    CHAR_DIGIT = 1 << 1,
+    CHAR_ALPHA = 1 << 2,
+    CHAR_ALNUM = CHAR_DIGIT | CHAR_ALPHA
+};
+
+// 256-entry lookup tables indexed by byte value. They match the "C" locale and,
+// unlike <cctype>, are safe to index with bytes above 0x7f.
+struct CharTables
+{
+    uint8_t classes[256];
+    TokenType single_char_tokens[256];
+};
+
+constexpr CharTables buildCharTables()
+{
+    CharTables tables{};
+    for (int c = 0; c < 256; c++)
+    {
+        uint8_t cls = 0;
+        if (c == ' ' || (c >= '\t' && c <= '\r'))
+            cls |= CHAR_SPACE;
+        if (c >= '0' && c <= '9')
+            cls |= CHAR_DIGIT;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+            cls |= CHAR_ALPHA;
+        tables.classes[c] = cls;
+        tables.single_char_tokens[c] = TokenType::UNKNOWN;
+    }
+    tables.single_char_tokens['+'] = TokenType::OPERATOR_PLUS;
+    tables.single_char_tokens['-'] = TokenType::OPERATOR_MINUS;
+    tables.single_char_tokens['*'] = TokenType::OPERATOR_MULTIPLY;
+    tables.single_char_tokens['/'] = TokenType::OPERATOR_DIVIDE;
+    tables.single_char_tokens['='] = TokenType::OPERATOR_ASSIGN;
+    tables.single_char_tokens[';'] = TokenType::PUNCTUATION_SEMICOLON;
+    tables.single_char_tokens['('] = TokenType::PUNCTUATION_LPAREN;
+    tables.single_char_tokens[')'] = TokenType::PUNCTUATION_RPAREN;
+    return tables;
+}
+
+constexpr CharTables CHAR_TABLES = buildCharTables();
+
+inline uint8_t charClass(char c) { return CHAR_TABLES.classes[static_cast<unsigned char>(c)]; }
+
+// Reference implementation of run scanning: returns the position of the first byte
+// at or after pos that is not in any of the classes in cls.
+inline size_t findRunEndScalar(std::string_view text, size_t pos, uint8_t cls)
+{
+    while (pos < text.size() && (charClass(text[pos]) & cls))
+    {
+        pos++;
+    }
+    return pos;
+}
+
+// Vectorized run scanning. simdRunLength<cls>(p) returns how many of the SIMD_WIDTH
+// bytes at p belong to cls before the first one that does not. Define
+// MINI_COMPILER_SCALAR_LEXER to build with the scalar reference path only.
+#if !defined(MINI_COMPILER_SCALAR_LEXER) && defined(__GNUC__) && defined(__AVX2__)
+#define MINI_COMPILER_SIMD_LEXER
+constexpr size_t SIMD_WIDTH = 32;
+
+inline __m256i simdInRange(__m256i v, char lo, char hi)
+{
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+    __m256i limit = _mm256_set1_epi8(static_cast<char>(hi - lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, limit), shifted);
+}
+
+template <uint8_t Cls>
+inline size_t simdRunLength(const char *p)
+{
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i in = _mm256_setzero_si256();
+    if (Cls & CHAR_SPACE)
+        in = _mm256_or_si256(in, _mm256_or_si256(simdInRange(v, '\t', '\r'), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '))));
+    if (Cls & CHAR_DIGIT)
+        in = _mm256_or_si256(in, simdInRange(v, '0', '9'));
+    if (Cls & CHAR_ALPHA)
+        in = _mm256_or_si256(in, simdInRange(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z'));
+    uint32_t miss = ~static_cast<uint32_t>(_mm256_movemask_epi8(in));
+    return miss ? __builtin_ctz(miss) : SIMD_WIDTH;
+}
+#elif !defined(MINI_COMPILER_SCALAR_LEXER) && defined(__GNUC__) && defined(__SSE2__)
+#define MINI_COMPILER_SIMD_LEXER
+constexpr size_t SIMD_WIDTH = 16;
+
+inline __m128i simdInRange(__m128i v, char lo, char hi)
+{
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+    __m128i limit = _mm_set1_epi8(static_cast<char>(hi - lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, limit), shifted);
+}
+
+template <uint8_t Cls>
+inline size_t simdRunLength(const char *p)
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i in = _mm_setzero_si128();
+    if (Cls & CHAR_SPACE)
+        in = _mm_or_si128(in, _mm_or_si128(simdInRange(v, '\t', '\r'), _mm_cmpeq_epi8(v, _mm_set1_epi8(' '))));
+    if (Cls & CHAR_DIGIT)
+        in = _mm_or_si128(in, simdInRange(v, '0', '9'));
+    if (Cls & CHAR_ALPHA)
+        in = _mm_or_si128(in, simdInRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z'));
+    uint32_t miss = ~static_cast<uint32_t>(_mm_movemask_epi8(in)) & 0xffffu;
+    return miss ? __builtin_ctz(miss) : SIMD_WIDTH;
+}
+#elif !defined(MINI_COMPILER_SCALAR_LEXER) && defined(__GNUC__) && defined(__ARM_NEON)
+#define MINI_COMPILER_SIMD_LEXER
+constexpr size_t SIMD_WIDTH = 16;
+
+inline uint8x16_t simdInRange(uint8x16_t v, char lo, char hi)
+{
+    return vcleq_u8(vsubq_u8(v, vdupq_n_u8(static_cast<uint8_t>(lo))), vdupq_n_u8(static_cast<uint8_t>(hi - lo)));
+}
+
+template <uint8_t Cls>
+inline size_t simdRunLength(const char *p)
+{
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    uint8x16_t in = vdupq_n_u8(0);
+    if (Cls & CHAR_SPACE)
+        in = vorrq_u8(in, vorrq_u8(simdInRange(v, '\t', '\r'), vceqq_u8(v, vdupq_n_u8(' '))));
+    if (Cls & CHAR_DIGIT)
+        in = vorrq_u8(in, simdInRange(v, '0', '9'));
+    if (Cls & CHAR_ALPHA)
+        in = vorrq_u8(in, simdInRange(vorrq_u8(v, vdupq_n_u8(0x20)), 'a', 'z'));
+    // Narrow each byte of the mask to a nibble so the whole mask fits in 64 bits.
+    uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(in), 4)), 0);
+    uint64_t miss = ~bits;
+    return miss ? __builtin_ctzll(miss) / 4 : SIMD_WIDTH;
+}
+#endif
+
+// Reference implementation of literal conversion: the value of a run of decimal digits,
+// or LITERAL_OUT_OF_RANGE if it does not fit in int64_t.
+inline int64_t parseDecimalScalar(std::string_view digits)
+{
+    uint64_t value = 0;
+    for (char c : digits)
+    {
+        uint64_t digit = static_cast<uint64_t>(c - '0');
+        if (value > (static_cast<uint64_t>(INT64_MAX) - digit) / 10)
+            return LITERAL_OUT_OF_RANGE;
+        value = value * 10 + digit;
+    }
+    return static_cast<int64_t>(value);
+}
+
+// SWAR literal conversion: eight digits are combined in three multiply steps inside
+// one 64-bit word, pairs first, then groups of four, then the full eight. The word is
+// read in memory order, so this needs a little-endian target and is disabled with
+// MINI_COMPILER_SCALAR_LEXER like the SIMD run scanning.
+#if !defined(MINI_COMPILER_SCALAR_LEXER) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define MINI_COMPILER_SWAR_DIGITS
+
+// Value of the eight ASCII digits at p.
+inline uint32_t parseEightDigits(const char *p)
+{
+    uint64_t chunk;
+    std::memcpy(&chunk, p, sizeof(chunk));
+    chunk -= 0x3030303030303030ull;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & 0x000000FF000000FFull) * (100 + (1000000ull << 32)) +
+             ((chunk >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32))) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+#endif
+
+// Converts a run of decimal digits as parseDecimalScalar() does.
+inline int64_t parseDecimal(std::string_view digits)
+{
+#ifdef MINI_COMPILER_SWAR_DIGITS
+    // Any 19 digits fit in uint64_t; a longer run fits only after its leading zeros.
+    if (digits.size() > 19)
+    {
+        size_t zeros = std::min(digits.find_first_not_of('0'), digits.size());
+        digits.remove_prefix(zeros);
+        if (digits.size() > 19)
+            return LITERAL_OUT_OF_RANGE;
+    }
+    uint64_t value = 0;
+    size_t pos = 0;
+    for (; pos + 8 <= digits.size(); pos += 8)
+    {
+        value = value * 100000000 + parseEightDigits(digits.data() + pos);
+    }
+    for (; pos < digits.size(); pos++)
+    {
+        value = value * 10 + static_cast<uint64_t>(digits[pos] - '0');
+    }
+    return value > static_cast<uint64_t>(INT64_MAX) ? LITERAL_OUT_OF_RANGE : static_cast<int64_t>(value);
+#else
+    return parseDecimalScalar(digits);
+#endif
+}
+
+// Returns the position of the first byte at or after pos that is not in Cls.
+template <uint8_t Cls>
+inline size_t findRunEnd(std::string_view text, size_t pos)
+{
+#ifdef MINI_COMPILER_SIMD_LEXER
+    // Most tokens and gaps are a few bytes long, which the scalar loop finishes before a
+    // vector load pays off, so only a run still going after SCALAR_PREFIX bytes is
+    // handed to simdRunLength.
+    constexpr size_t SCALAR_PREFIX = 16;
+    size_t prefix_end = std::min(text.size(), pos + SCALAR_PREFIX);
+    while (pos < prefix_end && (charClass(text[pos]) & Cls))
+    {
+        pos++;
+    }
+    if (pos < prefix_end)
+        return pos;
+    while (pos + SIMD_WIDTH <= text.size())
+    {
+        size_t run = simdRunLength<Cls>(text.data() + pos);
+        pos += run;
+        if (run < SIMD_WIDTH)
+            return pos;
+    }
+#endif
+    return findRunEndScalar(text, pos, Cls);
+}
+
+// This class is responsible for turning a string of source code into a list of tokens.
+// Identifiers are interned into the given Interner.
+class Lexer
+{
+public:
+    Lexer(std::string_view source, Interner &interner)
+        : source_code(source), current_pos(0), interner(interner) {}
+
+    Token getNextToken()
+    {
+#ifndef MINI_COMPILER_NO_STATS
+        token_count++;
+#endif
+        skipWhitespace();
+
+        if (current_pos >= source_code.length())
+        {
+            return {TokenType::END_OF_FILE, source_code.substr(current_pos, 0)};
+        }
+
+        char current_char = source_code[current_pos];
+
+        TokenType single = CHAR_TABLES.single_char_tokens[static_cast<unsigned char>(current_char)];
+        if (single != TokenType::UNKNOWN)
+        {
+            return {single, source_code.substr(current_pos++, 1)};
+        }
+
+        uint8_t cls = charClass(current_char);
+        if (cls & CHAR_DIGIT)
+        {
+            return readInteger();
+        }
+
+        if (cls & CHAR_ALPHA)
+        {
+            return readIdentifierOrKeyword();
+        }
+
+        return {TokenType::UNKNOWN, source_code.substr(current_pos++, 1)};
+    }
+
+    // Tokens returned so far, including END_OF_FILE; always 0 with MINI_COMPILER_NO_STATS.
+    size_t tokenCount() const { return token_count; }
+
+    std::string_view source() const { return source_code; }
+
+private:
+    std::string_view source_code;
+    size_t current_pos;
+    Interner &interner;
+    size_t token_count = 0;
+
+    void skipWhitespace()
+    {
+        current_pos = findRunEnd<CHAR_SPACE>(source_code, current_pos);
+    }
+
+    Token readInteger()
+    {
+        size_t start_pos = current_pos;
+        current_pos = findRunEnd<CHAR_DIGIT>(source_code, current_pos);
+        std::string_view value = source_code.substr(start_pos, current_pos - start_pos);
+        return {TokenType::INTEGER_LITERAL, value, NO_SYMBOL, parseDecimal(value)};
+    }
+
+    Token readIdentifierOrKeyword()
+    {
+        size_t start_pos = current_pos;
+        current_pos = findRunEnd<CHAR_ALNUM>(source_code, current_pos);
+        std::string_view value = source_code.substr(start_pos, current_pos - start_pos);
+
+        TokenType keyword = lookupKeyword(value);
+        if (keyword != TokenType::IDENTIFIER)
+        {
+            return {keyword, value};
+        }
+
+        return {TokenType::IDENTIFIER, value, interner.intern(value)};
+    }
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef MINI_COMPILER_OUTPUT_H
+#define MINI_COMPILER_OUTPUT_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+// A run of spaces that indentation is copied from, so no line builds its own.
+struct IndentSpaces
+{
+    char spaces[256];
+};
+
+constexpr IndentSpaces buildIndentSpaces()
+{
+    IndentSpaces indent{};
+    for (char &c : indent.spaces)
+    {
+        c = ' ';
+    }
+    return indent;
+}
+
+inline constexpr IndentSpaces INDENT_SPACES = buildIndentSpaces();
+
+// Collects output in a fixed buffer and hands it to the stream in large writes, so a
+// dump of many short lines costs a memcpy per piece instead of a formatted stream
+// insertion each. Whatever is left is written when the buffer is flushed or destroyed.
+class OutputBuffer
+{
+public:
+    explicit OutputBuffer(std::ostream &out) : out(out) {}
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    void write(std::string_view text)
+    {
+        if (text.size() > CAPACITY - used)
+        {
+            flush();
+            if (text.size() > CAPACITY)
+            {
+                out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return;
+            }
+        }
+        std::memcpy(buffer + used, text.data(), text.size());
+        used += text.size();
+    }
+
+    void put(char c)
+    {
+        if (used == CAPACITY)
+            flush();
+        buffer[used++] = c;
+    }
+
+    void writeInt(int64_t value)
+    {
+        if (CAPACITY - used < 20)
+            flush();
+        used = static_cast<size_t>(std::to_chars(buffer + used, buffer + CAPACITY, value).ptr - buffer);
+    }
+
+    void indent(size_t count)
+    {
+        while (count > 0)
+        {
+            size_t n = std::min(count, sizeof(INDENT_SPACES.spaces));
+            write(std::string_view(INDENT_SPACES.spaces, n));
+            count -= n;
+        }
+    }
+
+    // Writes text as a quoted JSON string.
+    void writeJsonString(std::string_view text)
+    {
+        put('"');
+        for (char c : text)
+        {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\')
+            {
+                put('\\');
+                put(c);
+            }
+            else if (byte < 0x20)
+            {
+                const char *hex = "0123456789abcdef";
+                write("\\u00");
+                put(hex[byte >> 4]);
+                put(hex[byte & 15]);
+            }
+            else
+            {
+                put(c);
+            }
+        }
+        put('"');
+    }
+
+    void flush()
+    {
+        if (used == 0)
+            return;
+        out.write(buffer, static_cast<std::streamsize>(used));
+        used = 0;
+    }
+
+private:
+    static constexpr size_t CAPACITY = 64 * 1024;
+
+    std::ostream &out;
+    size_t used = 0;
+    char buffer[CAPACITY];
+};
+
+#endif
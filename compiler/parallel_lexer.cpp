@@ -0,0 +1,113 @@
+#include "parallel_lexer.h"
+
+#include "lexer.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+std::vector<std::string_view> splitAtWhitespace(std::string_view source, size_t chunk_count)
+{
+    std::vector<std::string_view> chunks;
+    size_t start = 0;
+    for (size_t i = 1; i < chunk_count && start < source.size(); i++)
+    {
+        size_t cut = std::max(start, source.size() / chunk_count * i);
+        while (cut < source.size() && !(charClass(source[cut]) & CHAR_SPACE))
+        {
+            cut++;
+        }
+        if (cut == source.size())
+            break;
+        chunks.push_back(source.substr(start, cut - start));
+        start = cut;
+    }
+    chunks.push_back(source.substr(start));
+    return chunks;
+}
+
+void lexParallel(std::string_view source, Interner &interner, std::vector<Token> &tokens, size_t thread_count)
+{
+    constexpr size_t MIN_CHUNK_BYTES = 256 * 1024;
+    if (thread_count == 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::max<size_t>(1, std::min(thread_count, source.size() / MIN_CHUNK_BYTES));
+
+    std::vector<std::string_view> chunks = splitAtWhitespace(source, thread_count);
+    if (chunks.size() == 1)
+    {
+        Lexer lexer(source, interner);
+        for (Token token = lexer.getNextToken(); token.type != TokenType::END_OF_FILE; token = lexer.getNextToken())
+        {
+            tokens.push_back(token);
+        }
+        return;
+    }
+
+    struct ChunkResult
+    {
+        std::unique_ptr<Interner> interner; // null for the first chunk, which uses the caller's
+        std::vector<Token> tokens;
+        std::vector<uint32_t> remap; // chunk symbol ID -> ID in the caller's interner
+        size_t offset = 0;           // of the chunk's first token in the output
+    };
+    std::vector<ChunkResult> results(chunks.size());
+
+    // Runs work(i) for every chunk, chunk 0 on the calling thread.
+    auto forEachChunk = [&](auto work)
+    {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < chunks.size(); i++)
+        {
+            workers.emplace_back(work, i);
+        }
+        work(0);
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    };
+
+    forEachChunk([&](size_t i)
+                 {
+                     ChunkResult &result = results[i];
+                     if (i > 0)
+                         result.interner = std::make_unique<Interner>();
+                     result.tokens.reserve(chunks[i].size() / 4);
+                     Lexer lexer(chunks[i], i > 0 ? *result.interner : interner);
+                     for (Token token = lexer.getNextToken(); token.type != TokenType::END_OF_FILE;
+                          token = lexer.getNextToken())
+                     {
+                         result.tokens.push_back(token);
+                     }
+                 });
+
+    // Interning in chunk order assigns IDs by first appearance, as a serial lex does.
+    size_t total = tokens.size();
+    for (ChunkResult &result : results)
+    {
+        result.offset = total;
+        total += result.tokens.size();
+        if (!result.interner)
+            continue;
+        result.remap.resize(result.interner->size());
+        for (uint32_t symbol = 0; symbol < result.remap.size(); symbol++)
+        {
+            result.remap[symbol] = interner.intern(result.interner->name(symbol));
+        }
+    }
+
+    tokens.resize(total);
+    forEachChunk([&](size_t i)
+                 {
+                     ChunkResult &result = results[i];
+                     Token *out = tokens.data() + result.offset;
+                     for (Token token : result.tokens)
+                     {
+                         if (token.symbol != NO_SYMBOL && result.interner)
+                             token.symbol = result.remap[token.symbol];
+                         *out++ = token;
+                     }
+                     result.tokens = {};
+                 });
+}
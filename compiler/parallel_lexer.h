@@ -0,0 +1,22 @@
+#ifndef MINI_COMPILER_PARALLEL_LEXER_H
+#define MINI_COMPILER_PARALLEL_LEXER_H
+
+#include "interner.h"
+#include "token.h"
+
+#include <string_view>
+#include <vector>
+
+// Splits source into at most chunk_count pieces of roughly equal size, each cut just
+// before a whitespace byte. No token contains whitespace, so every chunk lexes exactly
+// as it would in place. A piece with no whitespace after its target size runs on.
+std::vector<std::string_view> splitAtWhitespace(std::string_view source, size_t chunk_count);
+
+// Lexes all of source into tokens, END_OF_FILE excluded, with the chunks from
+// splitAtWhitespace lexed on separate threads, each interning into its own Interner.
+// Chunk symbols are then merged into interner in chunk order, so the tokens, their
+// text views and their symbol IDs are exactly those of a serial Lexer. Tokens are
+// appended to what tokens already holds. Small inputs use fewer threads, down to one.
+void lexParallel(std::string_view source, Interner &interner, std::vector<Token> &tokens, size_t thread_count = 0);
+
+#endif
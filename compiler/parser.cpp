@@ -0,0 +1,128 @@
+#include "parser.h"
+
+#include <thread>
+
+void remapSymbols(AstNode *root, const std::vector<uint32_t> &remap)
+{
+    auto remapToken = [&](Token &token)
+    {
+        if (token.symbol != NO_SYMBOL)
+            token.symbol = remap[token.symbol];
+    };
+    std::vector<AstNode *> stack{root};
+    while (!stack.empty())
+    {
+        AstNode *node = stack.back();
+        stack.pop_back();
+        switch (node->kind)
+        {
+        case NodeKind::VAR_DECL:
+        {
+            auto p = static_cast<VarDeclNode *>(node);
+            remapToken(p->identifier);
+            stack.push_back(p->expression);
+            break;
+        }
+        case NodeKind::BINARY_OP:
+        {
+            auto p = static_cast<BinaryOpNode *>(node);
+            stack.push_back(p->left);
+            stack.push_back(p->right);
+            break;
+        }
+        case NodeKind::VARIABLE:
+            remapToken(static_cast<VariableNode *>(node)->identifier);
+            break;
+        case NodeKind::NUMBER:
+            break;
+        }
+    }
+}
+
+std::vector<std::string_view> splitAtStatementBoundaries(std::string_view source, size_t chunk_count)
+{
+    std::vector<std::string_view> chunks;
+    size_t start = 0;
+    for (size_t i = 1; i < chunk_count && start < source.size(); i++)
+    {
+        size_t target = std::max(start, source.size() / chunk_count * i);
+        size_t semicolon = source.find(';', target);
+        if (semicolon == std::string_view::npos)
+            break;
+        chunks.push_back(source.substr(start, semicolon + 1 - start));
+        start = semicolon + 1;
+    }
+    chunks.push_back(source.substr(start));
+    return chunks;
+}
+
+ParallelParseResult parseProgramParallel(std::string_view source, Interner &interner, size_t thread_count,
+                                         std::ostream &errors)
+{
+    constexpr size_t MIN_CHUNK_BYTES = 64 * 1024;
+    if (thread_count == 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::max<size_t>(1, std::min(thread_count, source.size() / MIN_CHUNK_BYTES));
+
+    std::vector<std::string_view> chunks = splitAtStatementBoundaries(source, thread_count);
+    struct ChunkResult
+    {
+        std::unique_ptr<Arena> arena = std::make_unique<Arena>();
+        std::unique_ptr<Interner> interner; // null for the first chunk, which uses the caller's
+        std::vector<AstNode *> statements;
+        Diagnostics diagnostics;
+        size_t tokens = 0;
+        bool ok = true;
+    };
+    std::vector<ChunkResult> results(chunks.size());
+
+    auto parseChunk = [&](size_t i)
+    {
+        ChunkResult &result = results[i];
+        if (i > 0)
+            result.interner = std::make_unique<Interner>();
+        // Chunks view into source, so their offsets are already from its start.
+        result.diagnostics = Diagnostics(source);
+        Lexer lexer(chunks[i], i > 0 ? *result.interner : interner);
+        Parser parser(lexer, *result.arena, result.diagnostics);
+        result.ok = parser.parseProgram(result.statements);
+        // Only the last chunk's END_OF_FILE is one a serial parse would count.
+        result.tokens = lexer.tokenCount() - (i + 1 < chunks.size() ? 1 : 0);
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunks.size(); i++)
+    {
+        workers.emplace_back(parseChunk, i);
+    }
+    parseChunk(0);
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    ParallelParseResult program;
+    Diagnostics diagnostics(source);
+    std::vector<uint32_t> remap;
+    for (auto &result : results)
+    {
+        if (result.interner)
+        {
+            remap.resize(result.interner->size());
+            for (uint32_t symbol = 0; symbol < remap.size(); symbol++)
+            {
+                remap[symbol] = interner.intern(result.interner->name(symbol));
+            }
+            for (AstNode *statement : result.statements)
+            {
+                remapSymbols(statement, remap);
+            }
+        }
+        program.statements.insert(program.statements.end(), result.statements.begin(), result.statements.end());
+        program.arenas.push_back(std::move(result.arena));
+        program.tokens += result.tokens;
+        diagnostics.append(result.diagnostics, 0);
+        program.ok = program.ok && result.ok;
+    }
+    diagnostics.print(errors);
+    return program;
+}
@@ -0,0 +1,315 @@
+#ifndef MINI_COMPILER_PARSER_H
+#define MINI_COMPILER_PARSER_H
+
+#include "ast.h"
+#include "diagnostics.h"
+#include "interner.h"
+#include "lexer.h"
+
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Binding power of every binary operator, indexed by TokenType; 0 marks tokens that are
+// not binary operators. Higher levels bind tighter and every level is left-associative,
+// so adding an operator is one line here rather than another parsing function.
+struct PrecedenceTable
+{
+    uint8_t levels[static_cast<size_t>(TokenType::UNKNOWN) + 1];
+};
+
+constexpr PrecedenceTable buildPrecedenceTable()
+{
+    PrecedenceTable table{};
+    table.levels[static_cast<size_t>(TokenType::OPERATOR_PLUS)] = 1;
+    table.levels[static_cast<size_t>(TokenType::OPERATOR_MINUS)] = 1;
+    table.levels[static_cast<size_t>(TokenType::OPERATOR_MULTIPLY)] = 2;
+    table.levels[static_cast<size_t>(TokenType::OPERATOR_DIVIDE)] = 2;
+    return table;
+}
+
+constexpr PrecedenceTable PRECEDENCE_TABLE = buildPrecedenceTable();
+
+inline uint8_t binaryPrecedence(TokenType type) { return PRECEDENCE_TABLE.levels[static_cast<size_t>(type)]; }
+
+// This class pulls tokens from a Lexer on demand and builds an Abstract Syntax Tree
+// through a Builder (TreeBuilder or FlatBuilder), which decides how nodes are stored.
+// Only a small ring buffer of lookahead tokens is kept, so memory stays bounded no
+// matter how large the input is. Tokens only view the source text, so the source
+// must outlive the parser and the AST.
+//
+// Errors are recorded in a Diagnostics rather than printed as they are found. After an
+// error the parser skips to the next statement and goes on, so one pass over a file
+// reports all of its errors.
+template <typename Builder>
+class BasicParser
+{
+public:
+    using NodeRef = typename Builder::NodeRef;
+
+    // Prints the errors of each parse() or parseProgram() call to errors when it returns.
+    BasicParser(Lexer &lexer, Builder builder, std::ostream &errors = std::cerr)
+        : lexer(lexer), builder(builder), own_diagnostics(lexer.source()), diagnostics(own_diagnostics),
+          errors(&errors) {}
+
+    // Records errors in diagnostics and leaves them for the caller to print. The tokens
+    // of lexer must view into the source diagnostics measures offsets from.
+    BasicParser(Lexer &lexer, Builder builder, Diagnostics &diagnostics)
+        : lexer(lexer), builder(builder), diagnostics(diagnostics) {}
+
+    BasicParser(const BasicParser &) = delete;
+    BasicParser &operator=(const BasicParser &) = delete;
+
+    // Parses a single statement.
+    NodeRef parse()
+    {
+        NodeRef statement = parseStatement();
+        flushErrors();
+        return statement;
+    }
+
+    // Parses statements until the end of the input, appending the ones that parse in
+    // order. A statement with an error is skipped as synchronize() describes. Returns
+    // false if there were any errors.
+    bool parseProgram(std::vector<NodeRef> &statements)
+    {
+        size_t reported = diagnostics.size();
+        while (peek().type != TokenType::END_OF_FILE)
+        {
+            NodeRef statement = parseStatement();
+            if (statement)
+                statements.push_back(statement);
+            else
+                synchronize();
+        }
+        bool ok = diagnostics.size() == reported;
+        flushErrors();
+        return ok;
+    }
+
+private:
+    // Must be a power of two so ring positions can be masked.
+    static constexpr size_t LOOKAHEAD = 4;
+
+    Lexer &lexer;
+    Builder builder;
+    Diagnostics own_diagnostics;
+    Diagnostics &diagnostics;
+    std::ostream *errors = nullptr; // where own_diagnostics is printed
+    Token lookahead[LOOKAHEAD];
+    size_t head = 0;
+    size_t buffered = 0;
+    std::vector<NodeRef> operands; // reused by every parseExpression()
+    std::vector<Token> operators;
+
+    // Returns the token `ahead` positions past the current one, lexing more input as needed.
+    Token &peek(size_t ahead = 0)
+    {
+        while (buffered <= ahead)
+        {
+            lookahead[(head + buffered) & (LOOKAHEAD - 1)] = lexer.getNextToken();
+            buffered++;
+        }
+        return lookahead[(head + ahead) & (LOOKAHEAD - 1)];
+    }
+
+    void report(DiagnosticCode code) { diagnostics.report(code, peek()); }
+
+    void flushErrors()
+    {
+        if (!errors)
+            return;
+        own_diagnostics.print(*errors);
+        own_diagnostics.clear();
+    }
+
+    // Panic-mode recovery after an error: skips the rest of the statement up to and
+    // including its ';', or up to the next 'int', which can only start a declaration,
+    // so a missing ';' costs one statement rather than two.
+    void synchronize()
+    {
+        for (;;)
+        {
+            TokenType type = peek().type;
+            if (type == TokenType::END_OF_FILE || type == TokenType::KEYWORD_INT)
+                return;
+            advance();
+            if (type == TokenType::PUNCTUATION_SEMICOLON)
+                return;
+        }
+    }
+
+    void advance()
+    {
+        // END_OF_FILE is never consumed, so peek() keeps returning it.
+        if (peek().type == TokenType::END_OF_FILE)
+            return;
+        head = (head + 1) & (LOOKAHEAD - 1);
+        buffered--;
+    }
+
+    NodeRef parseStatement()
+    {
+        if (peek().type == TokenType::KEYWORD_INT)
+            return parseVariableDeclaration();
+        report(DiagnosticCode::EXPECTED_DECLARATION);
+        return {};
+    }
+
+    NodeRef parseVariableDeclaration()
+    {
+        Token type = peek();
+        advance(); // consume int
+
+        // ensure the next token is an identifier
+        if (peek().type != TokenType::IDENTIFIER)
+        {
+            report(DiagnosticCode::EXPECTED_IDENTIFIER);
+            return {};
+        }
+        Token identifier = peek();
+        advance(); // consume the identifier
+
+        if (peek().type != TokenType::OPERATOR_ASSIGN)
+        {
+            report(DiagnosticCode::EXPECTED_ASSIGN);
+            return {};
+        }
+        advance(); // consume equals
+
+        auto expression = parseExpression();
+        if (!expression)
+        {
+            return {};
+        }
+
+        if (peek().type != TokenType::PUNCTUATION_SEMICOLON)
+        {
+            report(DiagnosticCode::EXPECTED_SEMICOLON);
+            return {};
+        }
+        advance(); // consume semicolon
+
+        return builder.varDecl(type, identifier, expression);
+    }
+
+    // Precedence climbing in a single loop. Operands and pending operators live on
+    // explicit stacks instead of the call stack, so neither long operator chains nor
+    // deeply nested parentheses add call depth. An opening parenthesis is pushed as an
+    // operator of precedence 0, which no reduction passes.
+    NodeRef parseExpression()
+    {
+        operands.clear();
+        operators.clear();
+        for (;;)
+        {
+            bool after_operator = !operators.empty() && operators.back().type != TokenType::PUNCTUATION_LPAREN;
+            while (peek().type == TokenType::PUNCTUATION_LPAREN)
+            {
+                operators.push_back(peek());
+                advance();
+            }
+            // A literal that failed to convert has already been reported by parseTerm().
+            NodeRef operand = parseTerm();
+            if (!operand)
+            {
+                if (peek().type != TokenType::INTEGER_LITERAL)
+                    report(after_operator ? DiagnosticCode::EXPECTED_OPERAND_AFTER_OPERATOR
+                                          : DiagnosticCode::EXPECTED_OPERAND);
+                return {};
+            }
+            operands.push_back(operand);
+
+            // Close parentheses until an operator continues the expression. A ')' with no
+            // matching '(' ends the expression and is left to the caller.
+            while (peek().type == TokenType::PUNCTUATION_RPAREN)
+            {
+                reduce(1);
+                if (operators.empty())
+                    break;
+                operators.pop_back();
+                advance();
+            }
+            uint8_t precedence = binaryPrecedence(peek().type);
+            if (precedence == 0)
+                break;
+            reduce(precedence);
+            operators.push_back(peek());
+            advance();
+        }
+
+        reduce(1);
+        if (!operators.empty())
+        {
+            report(DiagnosticCode::EXPECTED_CLOSING_PARENTHESIS);
+            return {};
+        }
+        return operands.back();
+    }
+
+    // Combines the pending operators that bind at least as tightly as precedence with
+    // their operands, stopping at an opening parenthesis.
+    void reduce(uint8_t precedence)
+    {
+        while (!operators.empty() && binaryPrecedence(operators.back().type) >= precedence)
+        {
+            NodeRef right = operands.back();
+            operands.pop_back();
+            operands.back() = builder.binaryOp(operands.back(), operators.back(), right);
+            operators.pop_back();
+        }
+    }
+
+    NodeRef parseTerm()
+    {
+        Token token = peek();
+        if (token.type == TokenType::INTEGER_LITERAL)
+        {
+            if (token.number == LITERAL_OUT_OF_RANGE)
+            {
+                report(DiagnosticCode::LITERAL_OUT_OF_RANGE);
+                return {};
+            }
+            advance();
+            return builder.number(token, token.number);
+        }
+        if (token.type == TokenType::IDENTIFIER)
+        {
+            advance();
+            return builder.variable(token);
+        }
+        return {};
+    }
+};
+
+using Parser = BasicParser<TreeBuilder>;
+using FlatParser = BasicParser<FlatBuilder>;
+
+// Rewrites the symbol IDs in a tree through remap (old ID -> new ID), so trees parsed
+// with different Interners can be merged into one symbol space.
+void remapSymbols(AstNode *root, const std::vector<uint32_t> &remap);
+
+// Statements of a program parsed by parseProgramParallel, in source order.
+struct ParallelParseResult
+{
+    std::vector<std::unique_ptr<Arena>> arenas; // one per chunk, owning its nodes
+    std::vector<AstNode *> statements;
+    size_t tokens = 0; // lexed over all chunks, counted as Lexer::tokenCount() would serially
+    bool ok = true;
+};
+
+// Splits source into at most chunk_count pieces of roughly equal size, each ending just
+// after a ';'. The token grammar has no strings or comments, so a ';' byte is always a
+// PUNCTUATION_SEMICOLON token and every chunk lexes exactly as it would in place.
+std::vector<std::string_view> splitAtStatementBoundaries(std::string_view source, size_t chunk_count);
+
+// Parses a whole program by splitting it at statement boundaries and parsing the
+// chunks on separate threads, each with its own Lexer, Arena and Interner. Chunk
+// symbols are merged into interner afterwards in chunk order, which assigns the same
+// IDs a serial parse would. Errors are reported as a serial parse would: the errors of
+// all chunks are printed together in source order, and ok is false if there were any.
+ParallelParseResult parseProgramParallel(std::string_view source, Interner &interner, size_t thread_count = 0,
+                                         std::ostream &errors = std::cerr);
+
+#endif
@@ -0,0 +1,460 @@
+#include "passes.h"
+
+#include "image.h"
+#include "output.h"
+
+#include <string>
+
+FoldStats foldConstants(AstNode *&root, std::ostream &errors)
+{
+    FoldStats stats;
+    struct Item
+    {
+        AstNode **slot;
+        bool children_done;
+    };
+    std::vector<Item> stack{{&root, false}};
+    while (!stack.empty())
+    {
+        Item item = stack.back();
+        stack.pop_back();
+        AstNode *node = *item.slot;
+        switch (node->kind)
+        {
+        case NodeKind::VAR_DECL:
+            stack.push_back({&static_cast<VarDeclNode *>(node)->expression, false});
+            break;
+        case NodeKind::BINARY_OP:
+        {
+            auto p = static_cast<BinaryOpNode *>(node);
+            if (!item.children_done)
+            {
+                stack.push_back({item.slot, true});
+                stack.push_back({&p->right, false});
+                stack.push_back({&p->left, false});
+                break;
+            }
+            auto left = nodeAs<NumberNode>(p->left);
+            auto right = nodeAs<NumberNode>(p->right);
+            if (!left || !right)
+                break;
+            int64_t value;
+            ArithStatus status = applyBinaryOp(p->op.type, left->value, right->value, value);
+            if (status != ArithStatus::OK)
+            {
+                errors << "Error: " << arithStatusMessage(status) << " in constant expression " << left->value << " " << p->op.value << " " << right->value << "\n";
+                stats.overflowed++;
+                break;
+            }
+            left->value = value;
+            *item.slot = left;
+            stats.folded++;
+            break;
+        }
+        case NodeKind::NUMBER:
+        case NodeKind::VARIABLE:
+            break;
+        }
+    }
+    return stats;
+}
+
+DeadCodeStats eliminateDeadDeclarations(std::vector<AstNode *> &statements, const std::vector<uint32_t> &roots,
+                                        size_t symbol_count)
+{
+    DeadCodeStats stats;
+    std::vector<uint8_t> needed(symbol_count, 0);
+    for (uint32_t root : roots)
+    {
+        needed[root] = 1;
+    }
+    std::vector<uint8_t> live(statements.size(), 0);
+    std::vector<const AstNode *> stack;
+    for (size_t index = statements.size(); index-- > 0;)
+    {
+        auto decl = static_cast<const VarDeclNode *>(statements[index]);
+        uint8_t &declared = needed[decl->identifier.symbol];
+        live[index] = declared;
+        declared = 0;
+        // A live declaration's reads become needed; a dead one's nodes are only counted.
+        stack.assign(1, decl->expression);
+        size_t nodes = 1;
+        while (!stack.empty())
+        {
+            const AstNode *node = stack.back();
+            stack.pop_back();
+            nodes++;
+            if (node->kind == NodeKind::VARIABLE && live[index])
+            {
+                needed[static_cast<const VariableNode *>(node)->identifier.symbol] = 1;
+            }
+            else if (node->kind == NodeKind::BINARY_OP)
+            {
+                stack.push_back(static_cast<const BinaryOpNode *>(node)->left);
+                stack.push_back(static_cast<const BinaryOpNode *>(node)->right);
+            }
+        }
+        if (!live[index])
+        {
+            stats.declarations_removed++;
+            stats.nodes_removed += nodes;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t index = 0; index < statements.size(); index++)
+    {
+        if (live[index])
+            statements[kept++] = statements[index];
+    }
+    statements.resize(kept);
+    return stats;
+}
+
+void printAst(const AstNode *root, std::ostream &out)
+{
+    if (!root)
+        return;
+
+    // Each entry prints either a node or, when label is set, a "Left:"/"Right:"/"Value:" line.
+    struct Item
+    {
+        const AstNode *node;
+        int indent;
+        const char *label;
+    };
+    OutputBuffer buffer(out);
+    std::vector<Item> stack{{root, 0, nullptr}};
+    while (!stack.empty())
+    {
+        Item item = stack.back();
+        stack.pop_back();
+        buffer.indent(item.indent * 2);
+        if (item.label)
+        {
+            buffer.write(item.label);
+            buffer.put('\n');
+            continue;
+        }
+
+        switch (item.node->kind)
+        {
+        case NodeKind::VAR_DECL:
+        {
+            auto p = static_cast<const VarDeclNode *>(item.node);
+            buffer.write("VarDecl: ");
+            buffer.write(p->identifier.value);
+            buffer.write(" (");
+            buffer.write(p->type.value);
+            buffer.write(")\n");
+            stack.push_back({p->expression, item.indent + 2, nullptr});
+            stack.push_back({nullptr, item.indent + 1, "Value:"});
+            break;
+        }
+        case NodeKind::BINARY_OP:
+        {
+            auto p = static_cast<const BinaryOpNode *>(item.node);
+            buffer.write("BinaryOp: ");
+            buffer.write(p->op.value);
+            buffer.put('\n');
+            stack.push_back({p->right, item.indent + 2, nullptr});
+            stack.push_back({nullptr, item.indent + 1, "Right:"});
+            stack.push_back({p->left, item.indent + 2, nullptr});
+            stack.push_back({nullptr, item.indent + 1, "Left:"});
+            break;
+        }
+        case NodeKind::NUMBER:
+            buffer.write("Number: ");
+            buffer.writeInt(static_cast<const NumberNode *>(item.node)->value);
+            buffer.put('\n');
+            break;
+        case NodeKind::VARIABLE:
+            buffer.write("Variable: ");
+            buffer.write(static_cast<const VariableNode *>(item.node)->identifier.value);
+            buffer.put('\n');
+            break;
+        }
+    }
+}
+
+namespace
+{
+
+// Shared by the FlatAst and ParseImage overloads, which have the same members.
+template <typename Ast>
+void printFlat(const Ast &ast, uint32_t root, std::ostream &out)
+{
+    if (root == FlatAst::NONE)
+        return;
+
+    // Each entry prints either a node or, when label is set, a "Left:"/"Right:"/"Value:" line.
+    struct Item
+    {
+        uint32_t node;
+        int indent;
+        const char *label;
+    };
+    OutputBuffer buffer(out);
+    std::vector<Item> stack{{root, 0, nullptr}};
+    while (!stack.empty())
+    {
+        Item item = stack.back();
+        stack.pop_back();
+        buffer.indent(item.indent * 2);
+        if (item.label)
+        {
+            buffer.write(item.label);
+            buffer.put('\n');
+            continue;
+        }
+
+        uint32_t node = item.node;
+        const Token &token = ast.tokens[ast.main_tokens[node]];
+        switch (ast.kinds[node])
+        {
+        case NodeKind::VAR_DECL:
+            buffer.write("VarDecl: ");
+            buffer.write(token.value);
+            buffer.write(" (");
+            buffer.write(ast.tokens[ast.rhs[node]].value);
+            buffer.write(")\n");
+            stack.push_back({ast.lhs[node], item.indent + 2, nullptr});
+            stack.push_back({0, item.indent + 1, "Value:"});
+            break;
+        case NodeKind::BINARY_OP:
+            buffer.write("BinaryOp: ");
+            buffer.write(token.value);
+            buffer.put('\n');
+            stack.push_back({ast.rhs[node], item.indent + 2, nullptr});
+            stack.push_back({0, item.indent + 1, "Right:"});
+            stack.push_back({ast.lhs[node], item.indent + 2, nullptr});
+            stack.push_back({0, item.indent + 1, "Left:"});
+            break;
+        case NodeKind::NUMBER:
+            buffer.write("Number: ");
+            buffer.writeInt(ast.numberValue(node));
+            buffer.put('\n');
+            break;
+        case NodeKind::VARIABLE:
+            buffer.write("Variable: ");
+            buffer.write(token.value);
+            buffer.put('\n');
+            break;
+        }
+    }
+}
+
+// Writes the start of a JSON line for node id: {"id":N,"kind":"kind"
+void beginJsonNode(OutputBuffer &buffer, uint32_t id, const char *kind)
+{
+    buffer.write("{\"id\":");
+    buffer.writeInt(id);
+    buffer.write(",\"kind\":\"");
+    buffer.write(kind);
+    buffer.put('"');
+}
+
+// Writes ,"name":"text","symbol":N for a named token.
+void writeJsonName(OutputBuffer &buffer, const Token &token)
+{
+    buffer.write(",\"name\":");
+    buffer.writeJsonString(token.value);
+    buffer.write(",\"symbol\":");
+    buffer.writeInt(token.symbol);
+}
+
+void writeJsonLink(OutputBuffer &buffer, const char *field, uint32_t id)
+{
+    buffer.write(",\"");
+    buffer.write(field);
+    buffer.write("\":");
+    buffer.writeInt(id);
+}
+
+template <typename Ast>
+void printFlatJson(const Ast &ast, const uint32_t *roots, size_t root_count, std::ostream &out)
+{
+    struct Item
+    {
+        uint32_t node;
+        bool children_done;
+    };
+    OutputBuffer buffer(out);
+    std::vector<Item> stack;
+    std::vector<uint32_t> ids; // IDs of the children printed but not yet linked to their parent
+    uint32_t next_id = 0;
+    for (size_t i = 0; i < root_count; i++)
+    {
+        stack.push_back({roots[i], false});
+        while (!stack.empty())
+        {
+            Item item = stack.back();
+            stack.pop_back();
+            uint32_t node = item.node;
+            NodeKind kind = ast.kinds[node];
+            if (!item.children_done && (kind == NodeKind::BINARY_OP || kind == NodeKind::VAR_DECL))
+            {
+                stack.push_back({node, true});
+                if (kind == NodeKind::BINARY_OP)
+                    stack.push_back({ast.rhs[node], false});
+                stack.push_back({ast.lhs[node], false});
+                continue;
+            }
+            const Token &token = ast.tokens[ast.main_tokens[node]];
+            switch (kind)
+            {
+            case NodeKind::VAR_DECL:
+                beginJsonNode(buffer, next_id, "var_decl");
+                buffer.write(",\"type\":");
+                buffer.writeJsonString(ast.tokens[ast.rhs[node]].value);
+                writeJsonName(buffer, token);
+                writeJsonLink(buffer, "value", ids.back());
+                ids.pop_back();
+                break;
+            case NodeKind::BINARY_OP:
+                beginJsonNode(buffer, next_id, "binary_op");
+                buffer.write(",\"op\":");
+                buffer.writeJsonString(token.value);
+                writeJsonLink(buffer, "left", ids[ids.size() - 2]);
+                writeJsonLink(buffer, "right", ids.back());
+                ids.resize(ids.size() - 2);
+                break;
+            case NodeKind::NUMBER:
+                beginJsonNode(buffer, next_id, "number");
+                buffer.write(",\"value\":");
+                buffer.writeInt(ast.numberValue(node));
+                break;
+            case NodeKind::VARIABLE:
+                beginJsonNode(buffer, next_id, "variable");
+                writeJsonName(buffer, token);
+                break;
+            }
+            buffer.write("}\n");
+            ids.push_back(next_id++);
+        }
+        ids.clear();
+    }
+}
+
+} // namespace
+
+void printFlatAst(const FlatAst &ast, uint32_t root, std::ostream &out)
+{
+    printFlat(ast, root, out);
+}
+
+void printFlatAst(const ParseImage &image, uint32_t root, std::ostream &out)
+{
+    printFlat(image, root, out);
+}
+
+void printAstJson(const std::vector<AstNode *> &statements, std::ostream &out)
+{
+    struct Item
+    {
+        const AstNode *node;
+        bool children_done;
+    };
+    OutputBuffer buffer(out);
+    std::vector<Item> stack;
+    std::vector<uint32_t> ids; // IDs of the children printed but not yet linked to their parent
+    uint32_t next_id = 0;
+    for (const AstNode *statement : statements)
+    {
+        stack.push_back({statement, false});
+        while (!stack.empty())
+        {
+            Item item = stack.back();
+            stack.pop_back();
+            switch (item.node->kind)
+            {
+            case NodeKind::VAR_DECL:
+            {
+                auto p = static_cast<const VarDeclNode *>(item.node);
+                if (!item.children_done)
+                {
+                    stack.push_back({p, true});
+                    stack.push_back({p->expression, false});
+                    continue;
+                }
+                beginJsonNode(buffer, next_id, "var_decl");
+                buffer.write(",\"type\":");
+                buffer.writeJsonString(p->type.value);
+                writeJsonName(buffer, p->identifier);
+                writeJsonLink(buffer, "value", ids.back());
+                ids.pop_back();
+                break;
+            }
+            case NodeKind::BINARY_OP:
+            {
+                auto p = static_cast<const BinaryOpNode *>(item.node);
+                if (!item.children_done)
+                {
+                    stack.push_back({p, true});
+                    stack.push_back({p->right, false});
+                    stack.push_back({p->left, false});
+                    continue;
+                }
+                beginJsonNode(buffer, next_id, "binary_op");
+                buffer.write(",\"op\":");
+                buffer.writeJsonString(p->op.value);
+                writeJsonLink(buffer, "left", ids[ids.size() - 2]);
+                writeJsonLink(buffer, "right", ids.back());
+                ids.resize(ids.size() - 2);
+                break;
+            }
+            case NodeKind::NUMBER:
+                beginJsonNode(buffer, next_id, "number");
+                buffer.write(",\"value\":");
+                buffer.writeInt(static_cast<const NumberNode *>(item.node)->value);
+                break;
+            case NodeKind::VARIABLE:
+                beginJsonNode(buffer, next_id, "variable");
+                writeJsonName(buffer, static_cast<const VariableNode *>(item.node)->identifier);
+                break;
+            }
+            buffer.write("}\n");
+            ids.push_back(next_id++);
+        }
+        ids.clear();
+    }
+}
+
+void printFlatAstJson(const FlatAst &ast, const std::vector<FlatNodeRef> &statements, std::ostream &out)
+{
+    std::vector<uint32_t> roots;
+    roots.reserve(statements.size());
+    for (FlatNodeRef statement : statements)
+    {
+        roots.push_back(statement.index);
+    }
+    printFlatJson(ast, roots.data(), roots.size(), out);
+}
+
+void printFlatAstJson(const ParseImage &image, std::ostream &out)
+{
+    printFlatJson(image, image.statements, image.statementCount(), out);
+}
+
+ArithStatus evaluateProgram(const std::vector<AstNode *> &statements, std::vector<int64_t> &variables,
+                            size_t &failed_statement)
+{
+    variables.clear();
+    TreeEvaluator evaluator;
+    auto load = [&](uint32_t symbol) { return symbol < variables.size() ? variables[symbol] : 0; };
+    for (size_t i = 0; i < statements.size(); i++)
+    {
+        auto decl = nodeAs<VarDeclNode>(statements[i]);
+        int64_t value;
+        ArithStatus status = evaluator.evaluate(decl->expression, value, load);
+        if (status != ArithStatus::OK)
+        {
+            failed_statement = i;
+            return status;
+        }
+        if (variables.size() <= decl->identifier.symbol)
+            variables.resize(decl->identifier.symbol + 1, 0);
+        variables[decl->identifier.symbol] = value;
+    }
+    return ArithStatus::OK;
+}
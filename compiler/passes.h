@@ -0,0 +1,132 @@
+#ifndef MINI_COMPILER_PASSES_H
+#define MINI_COMPILER_PASSES_H
+
+#include "arith.h"
+#include "ast.h"
+
+#include <iostream>
+#include <vector>
+
+class ParseImage;
+
+// Counters reported by foldConstants.
+struct FoldStats
+{
+    size_t folded = 0;     // binary operations replaced by their value
+    size_t overflowed = 0; // operations left in place because they overflow or divide by zero
+};
+
+// Collapses every literal-only BinaryOpNode subtree under root into a single NumberNode.
+// The walk is bottom-up with an explicit stack, so deep chains cannot overflow the call
+// stack. A folded operation reuses its left operand's node, which keeps the token of its
+// leftmost literal for source positions; nothing is allocated. Operations that overflow
+// or divide by zero are reported on errors and left unfolded.
+FoldStats foldConstants(AstNode *&root, std::ostream &errors = std::cerr);
+
+// Counters reported by eliminateDeadDeclarations.
+struct DeadCodeStats
+{
+    size_t declarations_removed = 0;
+    size_t nodes_removed = 0; // in the removed declarations, their VarDeclNodes included
+};
+
+// Drops the declarations whose values cannot reach the final value of any symbol in
+// roots, keeping the rest in order. The program is straight-line, so use-def is one
+// backward walk: a declaration is live if its name is needed at that point, which
+// satisfies that need and makes its reads needed in turn. A name declared again before
+// it is read is dead at the earlier declaration. The needed set is a flat array indexed
+// by symbol, so the pass is O(nodes + symbols). A dropped declaration can no longer
+// fail at run time, and later declarations move down to fill its place.
+DeadCodeStats eliminateDeadDeclarations(std::vector<AstNode *> &statements, const std::vector<uint32_t> &roots,
+                                        size_t symbol_count);
+
+// Helper function to print the AST for verification. The walk uses an explicit stack,
+// so deep expressions cannot overflow the call stack, and output goes through an
+// OutputBuffer, so the stream sees a few large writes.
+void printAst(const AstNode *root, std::ostream &out = std::cout);
+
+// Prints a FlatAst in the same format as printAst, also with an explicit stack.
+void printFlatAst(const FlatAst &ast, uint32_t root, std::ostream &out = std::cout);
+
+// Prints a FlatAst stored in a parse image, straight from the mapped file.
+void printFlatAst(const ParseImage &image, uint32_t root, std::ostream &out = std::cout);
+
+// Prints a program as JSON lines for other tools: one object per node, children before
+// their parents, which refer to them by "id". IDs count up from 0 over the program, so
+// every printer below gives the same output for the same program, and with no
+// indentation the output grows linearly however deep the tree is. Objects look like
+//   {"id":0,"kind":"number","value":1}
+//   {"id":1,"kind":"variable","name":"a","symbol":0}
+//   {"id":2,"kind":"binary_op","op":"+","left":0,"right":1}
+//   {"id":3,"kind":"var_decl","type":"int","name":"x","symbol":1,"value":2}
+void printAstJson(const std::vector<AstNode *> &statements, std::ostream &out = std::cout);
+void printFlatAstJson(const FlatAst &ast, const std::vector<FlatNodeRef> &statements, std::ostream &out = std::cout);
+void printFlatAstJson(const ParseImage &image, std::ostream &out = std::cout);
+
+// Evaluates expression trees directly, using an explicit stack so deep expressions are
+// safe. Used as the reference evaluator and as the fallback for the JIT. The scratch
+// stacks are kept between calls.
+class TreeEvaluator
+{
+public:
+    // load(symbol) returns the current value of a variable.
+    template <typename Load>
+    ArithStatus evaluate(const AstNode *root, int64_t &result, Load load)
+    {
+        stack.assign(1, {root, false});
+        values.clear();
+        while (!stack.empty())
+        {
+            Item item = stack.back();
+            stack.pop_back();
+            switch (item.node->kind)
+            {
+            case NodeKind::NUMBER:
+                values.push_back(static_cast<const NumberNode *>(item.node)->value);
+                break;
+            case NodeKind::VARIABLE:
+                values.push_back(load(static_cast<const VariableNode *>(item.node)->identifier.symbol));
+                break;
+            case NodeKind::BINARY_OP:
+            {
+                auto p = static_cast<const BinaryOpNode *>(item.node);
+                if (!item.children_done)
+                {
+                    stack.push_back({p, true});
+                    stack.push_back({p->right, false});
+                    stack.push_back({p->left, false});
+                    break;
+                }
+                int64_t right = values.back();
+                values.pop_back();
+                ArithStatus status = applyBinaryOp(p->op.type, values.back(), right, values.back());
+                if (status != ArithStatus::OK)
+                    return status;
+                break;
+            }
+            case NodeKind::VAR_DECL:
+                break;
+            }
+        }
+        result = values.back();
+        return ArithStatus::OK;
+    }
+
+private:
+    struct Item
+    {
+        const AstNode *node;
+        bool children_done;
+    };
+    std::vector<Item> stack;
+    std::vector<int64_t> values;
+};
+
+// Walks each declaration's expression tree directly and stores the results in variables,
+// indexed by symbol ID; variables used before any declaration read 0. This is the
+// straightforward evaluator the bytecode VM is measured against. On failure returns the
+// status and the index of the failing statement in failed_statement.
+ArithStatus evaluateProgram(const std::vector<AstNode *> &statements, std::vector<int64_t> &variables,
+                            size_t &failed_statement);
+
+#endif
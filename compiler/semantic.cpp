@@ -0,0 +1,58 @@
+#include "semantic.h"
+
+SemanticStats SemanticAnalyzer::analyze(const std::vector<AstNode *> &statements, size_t symbol_count,
+                                        Diagnostics &diagnostics)
+{
+    SemanticStats stats;
+    declared.assign(symbol_count, NOT_DECLARED);
+    for (size_t index = 0; index < statements.size(); index++)
+    {
+        auto decl = static_cast<const VarDeclNode *>(statements[index]);
+        uint32_t &entry = declared[decl->identifier.symbol];
+        bool duplicate = entry < UNDEFINED_REPORTED;
+        if (duplicate)
+        {
+            stats.duplicates++;
+            diagnostics.report(DiagnosticCode::DUPLICATE_DECLARATION, decl->identifier);
+        }
+
+        // Right children are pushed first, so reads are visited in source order.
+        stack.assign(1, decl->expression);
+        while (!stack.empty())
+        {
+            const AstNode *node = stack.back();
+            stack.pop_back();
+            switch (node->kind)
+            {
+            case NodeKind::VARIABLE:
+            {
+                const Token &identifier = static_cast<const VariableNode *>(node)->identifier;
+                uint32_t &target = declared[identifier.symbol];
+                stats.references++;
+                if (target == NOT_DECLARED)
+                {
+                    diagnostics.report(DiagnosticCode::UNDEFINED_VARIABLE, identifier);
+                    target = UNDEFINED_REPORTED;
+                }
+                stats.undefined += target == UNDEFINED_REPORTED;
+                break;
+            }
+            case NodeKind::BINARY_OP:
+            {
+                auto p = static_cast<const BinaryOpNode *>(node);
+                stack.push_back(p->right);
+                stack.push_back(p->left);
+                break;
+            }
+            case NodeKind::NUMBER:
+            case NodeKind::VAR_DECL:
+                break;
+            }
+        }
+
+        stats.declarations++;
+        if (!duplicate)
+            entry = static_cast<uint32_t>(index);
+    }
+    return stats;
+}
@@ -0,0 +1,47 @@
+#ifndef MINI_COMPILER_SEMANTIC_H
+#define MINI_COMPILER_SEMANTIC_H
+
+#include "ast.h"
+#include "diagnostics.h"
+
+#include <cstdint>
+#include <vector>
+
+// Counters reported by SemanticAnalyzer::analyze.
+struct SemanticStats
+{
+    size_t declarations = 0;
+    size_t references = 0; // variables read
+    size_t duplicates = 0; // declarations of a name that is already declared
+    size_t undefined = 0;  // reads of a name before its first declaration
+};
+
+// Name resolution over a program's declarations in source order. A read resolves to
+// the first earlier declaration of its name; a declaration's own expression cannot see
+// it, so "int x = x;" reads an undefined x. Symbol IDs are dense, so the scope table is
+// a flat array indexed by symbol: a lookup is one load, with no hashing, probing or
+// allocation, and a pass is O(nodes + symbols). The table is kept between calls.
+class SemanticAnalyzer
+{
+public:
+    static constexpr uint32_t NOT_DECLARED = UINT32_MAX;
+
+    // Reports every redeclared name, and the first undefined read of each name, to
+    // diagnostics. symbol_count is the size of the Interner the program was parsed with.
+    SemanticStats analyze(const std::vector<AstNode *> &statements, size_t symbol_count, Diagnostics &diagnostics);
+
+    // Index of the statement that first declared symbol in the last analysis, or NOT_DECLARED.
+    uint32_t declaration(uint32_t symbol) const
+    {
+        return symbol < declared.size() && declared[symbol] < UNDEFINED_REPORTED ? declared[symbol] : NOT_DECLARED;
+    }
+
+private:
+    // Marks a name whose undefined read was reported, so later reads are only counted.
+    static constexpr uint32_t UNDEFINED_REPORTED = UINT32_MAX - 1;
+
+    std::vector<uint32_t> declared; // by symbol: declaring statement, or one of the markers
+    std::vector<const AstNode *> stack;
+};
+
+#endif
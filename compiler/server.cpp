@@ -0,0 +1,400 @@
+#include "server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <csignal>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Longest header line: "stats" or the decimal length of a request.
+constexpr size_t MAX_HEADER_BYTES = 32;
+
+} // namespace
+
+struct CompileServer::Connection
+{
+    int fd;
+    std::string input;
+    size_t input_pos = 0; // start of the first request not yet queued
+    std::string output;
+    size_t output_pos = 0; // start of the output not yet sent
+    size_t queued = 0;     // requests of this connection in pending
+    bool reading = true;   // false once the client has shut down its side
+    bool broken = false;   // closed without sending what is left
+};
+
+void printServerStats(const ServerStats &stats, std::ostream &out)
+{
+    double seconds = stats.uptime_ns / 1e9;
+    char line[160];
+    std::snprintf(line, sizeof(line), "Requests: %llu (%llu failed) in %llu batches, %.1f per batch, %llu connections\n",
+                  static_cast<unsigned long long>(stats.requests), static_cast<unsigned long long>(stats.failed),
+                  static_cast<unsigned long long>(stats.batches),
+                  stats.batches ? static_cast<double>(stats.requests) / stats.batches : 0.0,
+                  static_cast<unsigned long long>(stats.connections));
+    out << line;
+    std::snprintf(line, sizeof(line), "Throughput: %.1f requests/s, %.3f MB/s in, %.3f MB/s out over %.3f s\n",
+                  seconds > 0 ? stats.requests / seconds : 0.0, seconds > 0 ? stats.bytes_in / seconds / 1e6 : 0.0,
+                  seconds > 0 ? stats.bytes_out / seconds / 1e6 : 0.0, seconds);
+    out << line;
+    std::snprintf(line, sizeof(line), "Latency: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                  stats.latency.percentile(0.5) / 1e3, stats.latency.percentile(0.99) / 1e3,
+                  stats.latency.max() / 1e3);
+    out << line;
+}
+
+CompileServer::CompileServer(const DriverOptions &options, WorkStealingPool &pool, const ServerOptions &limits)
+    : options(options), limits(limits), pool(pool)
+{
+    this->options.cache = nullptr;
+    this->options.stats = nullptr;
+    this->options.parallel = false; // the requests themselves are spread over the cores
+    for (size_t worker = 0; worker < pool.threadCount(); worker++)
+    {
+        contexts.push_back(std::make_unique<CompilerContext>());
+    }
+}
+
+#ifndef _WIN32
+
+CompileServer::~CompileServer()
+{
+    for (auto &connection : connections)
+    {
+        close(connection->fd);
+    }
+    if (listen_fd >= 0)
+        close(listen_fd);
+    if (!socket_path.empty())
+        unlink(socket_path.c_str());
+    for (int fd : wake_fds)
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+bool CompileServer::listen(const std::string &address, std::ostream &errors)
+{
+    if (pipe(wake_fds) != 0)
+    {
+        errors << "Error: Cannot create a pipe: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    fcntl(wake_fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(wake_fds[1], F_SETFL, O_NONBLOCK);
+
+    bool tcp = !address.empty() && address.size() <= 5 &&
+               std::all_of(address.begin(), address.end(), [](char c) { return c >= '0' && c <= '9'; });
+    if (tcp && std::stoul(address) > UINT16_MAX)
+    {
+        errors << "Error: Port is out of range: " << address << "\n";
+        return false;
+    }
+    listen_fd = socket(tcp ? AF_INET : AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        errors << "Error: Cannot create a socket: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    int bound;
+    if (tcp)
+    {
+        int reuse = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in inet{};
+        inet.sin_family = AF_INET;
+        inet.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        inet.sin_port = htons(static_cast<uint16_t>(std::stoul(address)));
+        bound = bind(listen_fd, reinterpret_cast<sockaddr *>(&inet), sizeof(inet));
+        socklen_t length = sizeof(inet);
+        if (bound == 0 && getsockname(listen_fd, reinterpret_cast<sockaddr *>(&inet), &length) == 0)
+            bound_port = ntohs(inet.sin_port);
+    }
+    else
+    {
+        sockaddr_un local{};
+        local.sun_family = AF_UNIX;
+        if (address.size() >= sizeof(local.sun_path))
+        {
+            errors << "Error: Socket path is too long: " << address << "\n";
+            return false;
+        }
+        std::memcpy(local.sun_path, address.c_str(), address.size() + 1);
+        unlink(address.c_str());
+        bound = bind(listen_fd, reinterpret_cast<sockaddr *>(&local), sizeof(local));
+        if (bound == 0)
+            socket_path = address;
+    }
+    if (bound != 0 || ::listen(listen_fd, SOMAXCONN) != 0)
+    {
+        errors << "Error: Cannot listen on " << address << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    fcntl(listen_fd, F_SETFL, O_NONBLOCK);
+    started_ns = nowNs();
+    return true;
+}
+
+void CompileServer::stop()
+{
+    char byte = 0;
+    if (wake_fds[1] >= 0)
+        (void)!::write(wake_fds[1], &byte, 1);
+}
+
+void CompileServer::acceptConnections()
+{
+    while (true)
+    {
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0)
+            return;
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        connections.push_back(std::make_unique<Connection>());
+        connections.back()->fd = fd;
+        server_stats.connections++;
+    }
+}
+
+bool CompileServer::readRequests(Connection &connection)
+{
+    char buffer[64 * 1024];
+    while (true)
+    {
+        ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (received < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return false;
+        }
+        if (received == 0)
+        {
+            connection.reading = false;
+            break;
+        }
+        connection.input.append(buffer, static_cast<size_t>(received));
+    }
+
+    uint64_t now = nowNs();
+    while (true)
+    {
+        std::string_view rest = std::string_view(connection.input).substr(connection.input_pos);
+        size_t newline = rest.substr(0, MAX_HEADER_BYTES).find('\n');
+        if (newline == std::string_view::npos)
+        {
+            if (rest.size() >= MAX_HEADER_BYTES)
+                return false;
+            break;
+        }
+        std::string_view header = rest.substr(0, newline);
+        if (header == "stats")
+        {
+            // Queued like a compilation to keep the responses in order.
+            pending.push_back({&connection, {}, now, true, {}, {}, true});
+            connection.queued++;
+            connection.input_pos += newline + 1;
+            continue;
+        }
+        if (header.empty() || header.size() > 19 ||
+            !std::all_of(header.begin(), header.end(), [](char c) { return c >= '0' && c <= '9'; }))
+            return false;
+        size_t length = std::stoull(std::string(header));
+        if (length > limits.max_request_bytes)
+            return false;
+        if (rest.size() - newline - 1 < length)
+            break;
+        pending.push_back({&connection, std::string(rest.substr(newline + 1, length)), now, false, {}, {}, false});
+        connection.queued++;
+        connection.input_pos += newline + 1 + length;
+    }
+    // Drop the consumed requests once they are most of the buffer.
+    if (connection.input_pos > connection.input.size() / 2)
+    {
+        connection.input.erase(0, connection.input_pos);
+        connection.input_pos = 0;
+    }
+    return true;
+}
+
+bool CompileServer::writeResponses(Connection &connection)
+{
+    while (connection.output_pos < connection.output.size())
+    {
+        ssize_t sent = send(connection.fd, connection.output.data() + connection.output_pos,
+                            connection.output.size() - connection.output_pos, 0);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection.output_pos += static_cast<size_t>(sent);
+    }
+    connection.output.clear();
+    connection.output_pos = 0;
+    return true;
+}
+
+void CompileServer::compilePending()
+{
+    size_t count = std::min(pending.size(), limits.max_batch);
+    pool.run(count, [&](size_t worker, size_t index)
+             {
+                 CompilerContext &context = *contexts[worker];
+                 Request &request = pending[index];
+                 if (request.stats)
+                     return;
+                 std::ostringstream out;
+                 std::ostringstream errors;
+                 request.ok = compileSource(request.source, options, context, out, errors);
+                 request.output = out.str();
+                 request.errors = errors.str();
+             });
+
+    uint64_t now = nowNs();
+    server_stats.batches += std::any_of(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(count),
+                                        [](const Request &request) { return !request.stats; });
+    for (size_t index = 0; index < count; index++)
+    {
+        Request &request = pending[index];
+        Connection &connection = *request.connection;
+        connection.queued--;
+        if (request.stats)
+        {
+            std::ostringstream text;
+            printServerStats(stats(), text);
+            request.output = text.str();
+            request.ok = true;
+        }
+        if (!connection.broken)
+        {
+            connection.output += request.ok ? "ok " : "failed ";
+            connection.output += std::to_string(request.output.size());
+            connection.output += ' ';
+            connection.output += std::to_string(request.errors.size());
+            connection.output += '\n';
+            connection.output += request.output;
+            connection.output += request.errors;
+        }
+        if (request.stats)
+            continue;
+        server_stats.requests++;
+        server_stats.failed += !request.ok;
+        server_stats.bytes_in += request.source.size();
+        server_stats.bytes_out += request.output.size() + request.errors.size();
+        server_stats.latency.record(now - request.received_ns);
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+bool CompileServer::serve(std::ostream &errors)
+{
+    // A client that disconnects early must not kill the server when it is written to.
+    std::signal(SIGPIPE, SIG_IGN);
+    std::vector<pollfd> polled;
+    while (true)
+    {
+        // With requests still pending, only look at what is ready now and go on compiling.
+        polled.assign({{wake_fds[0], POLLIN, 0}, {listen_fd, POLLIN, 0}});
+        for (const auto &connection : connections)
+        {
+            short events = (connection->reading ? POLLIN : 0) | (connection->output.empty() ? 0 : POLLOUT);
+            polled.push_back({connection->fd, events, 0});
+        }
+        if (poll(polled.data(), polled.size(), pending.empty() ? -1 : 0) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            errors << "Error: Cannot poll: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        if (polled[0].revents)
+        {
+            char drained[64];
+            while (::read(wake_fds[0], drained, sizeof(drained)) > 0)
+            {
+            }
+            return true;
+        }
+        if (polled[1].revents)
+            acceptConnections();
+        // Connections accepted just now are polled from the next round on.
+        for (size_t i = 2; i < polled.size(); i++)
+        {
+            Connection &connection = *connections[i - 2];
+            if ((polled[i].revents & (POLLIN | POLLHUP | POLLERR)) && connection.reading && !readRequests(connection))
+                connection.broken = true;
+            if ((polled[i].revents & POLLOUT) && !writeResponses(connection))
+                connection.broken = true;
+        }
+
+        if (!pending.empty())
+            compilePending();
+
+        // Send what the batch produced right away, and close the connections that are
+        // broken, or finished with nothing left to answer or send.
+        for (auto &connection : connections)
+        {
+            if (!connection->broken && !connection->output.empty() && !writeResponses(*connection))
+                connection->broken = true;
+        }
+        auto finished = [](const std::unique_ptr<Connection> &c)
+        {
+            if (c->queued != 0 || !(c->broken || (!c->reading && c->output.empty())))
+                return false;
+            close(c->fd);
+            return true;
+        };
+        connections.erase(std::remove_if(connections.begin(), connections.end(), finished), connections.end());
+    }
+}
+
+#else
+
+CompileServer::~CompileServer() {}
+
+bool CompileServer::listen(const std::string &, std::ostream &errors)
+{
+    errors << "Error: The compile server is not supported on this platform\n";
+    return false;
+}
+
+bool CompileServer::serve(std::ostream &)
+{
+    return false;
+}
+
+void CompileServer::stop() {}
+
+#endif
+
+const ServerStats &CompileServer::stats()
+{
+    server_stats.uptime_ns = started_ns ? nowNs() - started_ns : 0;
+    return server_stats;
+}
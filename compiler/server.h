@@ -0,0 +1,112 @@
+#ifndef MINI_COMPILER_SERVER_H
+#define MINI_COMPILER_SERVER_H
+
+#include "context.h"
+#include "driver.h"
+#include "stats.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Limits of a CompileServer.
+struct ServerOptions
+{
+    size_t max_batch = 256;              // requests compiled in one pool run at most
+    size_t max_request_bytes = 16 << 20; // a longer request closes its connection
+};
+
+// What a CompileServer has done since it started listening.
+struct ServerStats
+{
+    uint64_t requests = 0; // compile requests answered
+    uint64_t failed = 0;   // of which compileSource returned false
+    uint64_t batches = 0;
+    uint64_t bytes_in = 0;  // of source text
+    uint64_t bytes_out = 0; // of output and errors
+    uint64_t connections = 0;
+    uint64_t uptime_ns = 0;
+    LatencyHistogram latency; // from the whole request being read to its response being queued
+};
+
+// Prints the counters, request and byte rates and the p50, p99 and maximum latencies.
+void printServerStats(const ServerStats &stats, std::ostream &out);
+
+// A long-running compile service. Clients connect to a Unix socket, or to a TCP port on
+// the loopback interface, and send any number of requests on one connection:
+//
+//   request:  "<length>\n" and then length bytes of source text
+//             "stats\n" for the printServerStats() text instead of a compilation
+//   response: "ok <output length> <error length>\n" or "failed ..." when compileSource
+//             returned false, and then the output and the error text
+//
+// Responses come back in request order. Everything runs on one thread polling the
+// sockets, apart from compilation: the requests read since the previous batch started,
+// up to max_batch, are compiled together on pool, where every worker keeps its own
+// CompilerContext so snippets reuse the same arena and interner. A lone request is
+// compiled at once, and under load batches grow by themselves. Every request is
+// compiled with options, except that cache and stats are ignored and parallel is off.
+class CompileServer
+{
+public:
+    CompileServer(const DriverOptions &options, WorkStealingPool &pool, const ServerOptions &limits = {});
+    CompileServer(const CompileServer &) = delete;
+    CompileServer &operator=(const CompileServer &) = delete;
+    ~CompileServer();
+
+    // Listens on address: a port number for 127.0.0.1, anything else a Unix socket path,
+    // which is replaced if it exists. Port 0 picks a free port, which port() returns.
+    bool listen(const std::string &address, std::ostream &errors = std::cerr);
+
+    uint16_t port() const { return bound_port; }
+
+    // Serves connections until stop(). Returns false if polling fails.
+    bool serve(std::ostream &errors = std::cerr);
+
+    // Makes serve() return after its current batch. Safe to call from another thread and
+    // from a signal handler.
+    void stop();
+
+    // Safe to call only from the thread running serve(), or once it has returned.
+    const ServerStats &stats();
+
+private:
+    struct Connection;
+    struct Request
+    {
+        Connection *connection;
+        std::string source;
+        uint64_t received_ns;
+        bool stats; // a "stats" request, answered without compiling
+        std::string output;
+        std::string errors;
+        bool ok = false;
+    };
+
+    DriverOptions options;
+    ServerOptions limits;
+    WorkStealingPool &pool;
+    std::vector<std::unique_ptr<CompilerContext>> contexts; // one per pool worker
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::vector<Request> pending;
+    ServerStats server_stats;
+    uint64_t started_ns = 0;
+    int listen_fd = -1;
+    int wake_fds[2] = {-1, -1}; // stop() writes to [1] to interrupt poll()
+    std::string socket_path;    // unlinked again on destruction
+    uint16_t bound_port = 0;
+
+    void acceptConnections();
+    // Reads what the connection has sent and queues its complete requests. Returns false
+    // once the connection should be closed.
+    bool readRequests(Connection &connection);
+    // Sends as much of the queued responses as the socket takes.
+    bool writeResponses(Connection &connection);
+    void compilePending();
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "source_file.h"
+
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceFile::~SourceFile()
+{
+#ifndef _WIN32
+    if (mapped_data)
+        munmap(mapped_data, mapped_size);
+#endif
+}
+
+bool SourceFile::open(const std::string &path, std::ostream &errors)
+{
+#ifndef _WIN32
+    if (path != "-" && mapFile(path))
+        return true;
+#endif
+    std::FILE *file = path == "-" ? stdin : std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        errors << "Error: Cannot open " << path << "\n";
+        return false;
+    }
+    char chunk[64 * 1024];
+    size_t count;
+    while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        buffer.append(chunk, count);
+    }
+    bool ok = !std::ferror(file);
+    if (file != stdin)
+        std::fclose(file);
+    if (!ok)
+        errors << "Error: Failed to read " << path << "\n";
+    return ok;
+}
+
+#ifndef _WIN32
+bool SourceFile::mapFile(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    mapped_data = data;
+    mapped_size = static_cast<size_t>(info.st_size);
+    return true;
+}
+#else
+bool SourceFile::mapFile(const std::string &)
+{
+    return false;
+}
+#endif
@@ -0,0 +1,39 @@
+#ifndef MINI_COMPILER_SOURCE_FILE_H
+#define MINI_COMPILER_SOURCE_FILE_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+// Holds the bytes of one input file. Regular files are memory-mapped so the lexer
+// scans the page cache directly; pipes, stdin and platforms without mmap fall back
+// to a streaming read into an owned buffer.
+class SourceFile
+{
+public:
+    SourceFile() = default;
+    SourceFile(const SourceFile &) = delete;
+    SourceFile &operator=(const SourceFile &) = delete;
+
+    ~SourceFile();
+
+    // Loads the file at path, or standard input when path is "-".
+    bool open(const std::string &path, std::ostream &errors = std::cerr);
+
+    std::string_view text() const
+    {
+        if (mapped_data)
+            return std::string_view(static_cast<const char *>(mapped_data), mapped_size);
+        return buffer;
+    }
+
+private:
+    void *mapped_data = nullptr;
+    size_t mapped_size = 0;
+    std::string buffer;
+
+    // Maps a non-empty regular file read-only. Returns false when the caller should stream instead.
+    bool mapFile(const std::string &path);
+};
+
+#endif
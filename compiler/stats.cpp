@@ -0,0 +1,82 @@
+#include "stats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+void CompileStats::print(std::ostream &out) const
+{
+    struct Total
+    {
+        const char *name;
+        size_t runs = 0;
+        uint64_t duration_ns = 0;
+        std::vector<std::pair<const char *, uint64_t>> counters;
+    };
+    std::vector<Total> totals;
+    for (const Phase &phase : phases)
+    {
+        auto total = std::find_if(totals.begin(), totals.end(), [&](const Total &t)
+                                  { return std::strcmp(t.name, phase.name) == 0; });
+        if (total == totals.end())
+            total = totals.insert(totals.end(), Total{phase.name, 0, 0, {}});
+        total->runs++;
+        total->duration_ns += phase.duration_ns;
+        for (const auto &[counter, value] : phase.counters)
+        {
+            auto sum = std::find_if(total->counters.begin(), total->counters.end(), [&](const auto &c)
+                                    { return std::strcmp(c.first, counter) == 0; });
+            if (sum == total->counters.end())
+                total->counters.push_back({counter, value});
+            else
+                sum->second += value;
+        }
+    }
+
+    out << "Phase        Runs    Time (ms)  Counters\n";
+    char line[64];
+    for (const Total &total : totals)
+    {
+        std::snprintf(line, sizeof(line), "%-10s %6zu %12.3f", total.name, total.runs, total.duration_ns / 1e6);
+        out << line;
+        for (const auto &[counter, value] : total.counters)
+        {
+            out << "  " << counter << "=" << value;
+        }
+        out << "\n";
+    }
+}
+
+void CompileStats::writeTrace(std::ostream &out) const
+{
+    uint64_t origin = UINT64_MAX;
+    for (const Phase &phase : phases)
+    {
+        origin = std::min(origin, phase.start_ns);
+    }
+    out << "{\"traceEvents\":[";
+    for (size_t i = 0; i < phases.size(); i++)
+    {
+        const Phase &phase = phases[i];
+        out << (i ? ",\n" : "\n") << "{\"name\":\"" << phase.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+            << phase.thread << ",\"ts\":";
+        writeMicroseconds(out, phase.start_ns - origin);
+        out << ",\"dur\":";
+        writeMicroseconds(out, phase.duration_ns);
+        out << ",\"args\":{";
+        for (size_t c = 0; c < phase.counters.size(); c++)
+        {
+            out << (c ? "," : "") << "\"" << phase.counters[c].first << "\":" << phase.counters[c].second;
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+}
+
+void CompileStats::writeMicroseconds(std::ostream &out, uint64_t ns)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%llu.%03u", static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned>(ns % 1000));
+    out << text;
+}
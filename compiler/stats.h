@@ -0,0 +1,183 @@
+#ifndef MINI_COMPILER_STATS_H
+#define MINI_COMPILER_STATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Wall-clock time and counters for the phases of a compilation, printed by --stats and
+// written as Chrome trace-event JSON by --trace (load it in chrome://tracing or Perfetto).
+// Phases are recorded through PhaseTimer, which does nothing when no CompileStats is
+// attached, so idle instrumentation costs a null check. Defining MINI_COMPILER_NO_STATS
+// turns PhaseTimer into an empty class and removes even that.
+class CompileStats
+{
+public:
+    struct Phase
+    {
+        const char *name;
+        uint64_t start_ns;
+        uint64_t duration_ns = 0;
+        uint32_t thread = 0;
+        std::vector<std::pair<const char *, uint64_t>> counters;
+    };
+
+    size_t begin(const char *name)
+    {
+        phases.push_back({name, now(), 0, 0, {}});
+        return phases.size() - 1;
+    }
+
+    void end(size_t phase) { phases[phase].duration_ns = now() - phases[phase].start_ns; }
+
+    void count(size_t phase, const char *counter, uint64_t value) { phases[phase].counters.push_back({counter, value}); }
+
+    // Appends the phases of other, e.g. those of one batch worker, tagged with thread.
+    void append(const CompileStats &other, uint32_t thread)
+    {
+        for (Phase phase : other.phases)
+        {
+            phase.thread = thread;
+            phases.push_back(std::move(phase));
+        }
+    }
+
+    const std::vector<Phase> &recorded() const { return phases; }
+
+    // Prints one line per phase name in order of first appearance, with the summed time
+    // and counters of every phase of that name.
+    void print(std::ostream &out) const;
+
+    // Writes the phases as complete ("X") trace events, with times in microseconds from
+    // the first phase and one trace thread per recorded thread.
+    void writeTrace(std::ostream &out) const;
+
+private:
+    std::vector<Phase> phases;
+
+    // Writes ns as microseconds with three decimals, never in exponent notation.
+    static void writeMicroseconds(std::ostream &out, uint64_t ns);
+
+    static uint64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+};
+
+// Counts durations in log-linear buckets: exact below 16 ns, then 16 buckets per power
+// of two, so a percentile is within 1/16 of the true value however many samples a
+// long-running process records, in a fixed 8 KiB.
+class LatencyHistogram
+{
+public:
+    void record(uint64_t ns)
+    {
+        buckets[bucketOf(ns)]++;
+        total++;
+        maximum = std::max(maximum, ns);
+    }
+
+    void merge(const LatencyHistogram &other)
+    {
+        for (size_t i = 0; i < BUCKETS; i++)
+        {
+            buckets[i] += other.buckets[i];
+        }
+        total += other.total;
+        maximum = std::max(maximum, other.maximum);
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maximum; }
+
+    // Lower bound of the bucket holding the sample at fraction (0.5 for the median) of the
+    // sorted samples, or 0 with none.
+    uint64_t percentile(double fraction) const
+    {
+        uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++)
+        {
+            seen += buckets[i];
+            if (seen > rank)
+                return lowerBound(i);
+        }
+        return total ? lowerBound(bucketOf(maximum)) : 0;
+    }
+
+private:
+    static constexpr size_t SUB_BUCKETS = 16;
+    static constexpr size_t BUCKETS = SUB_BUCKETS + (64 - 4) * SUB_BUCKETS;
+
+    uint64_t buckets[BUCKETS] = {};
+    uint64_t total = 0;
+    uint64_t maximum = 0;
+
+    static size_t bucketOf(uint64_t ns)
+    {
+        if (ns < SUB_BUCKETS)
+            return static_cast<size_t>(ns);
+        int exponent = 4;
+        while (exponent < 63 && ns >> (exponent + 1))
+        {
+            exponent++;
+        }
+        size_t sub = static_cast<size_t>(ns >> (exponent - 4)) & (SUB_BUCKETS - 1);
+        return SUB_BUCKETS + static_cast<size_t>(exponent - 4) * SUB_BUCKETS + sub;
+    }
+
+    static uint64_t lowerBound(size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+        size_t exponent = (bucket - SUB_BUCKETS) / SUB_BUCKETS + 4;
+        uint64_t sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+        return (SUB_BUCKETS + sub) << (exponent - 4);
+    }
+};
+
+#ifndef MINI_COMPILER_NO_STATS
+// Records one phase into stats for the lifetime of the timer; a no-op when stats is null.
+class PhaseTimer
+{
+public:
+    PhaseTimer(CompileStats *stats, const char *name) : stats(stats)
+    {
+        if (stats)
+            phase = stats->begin(name);
+    }
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+    ~PhaseTimer()
+    {
+        if (stats)
+            stats->end(phase);
+    }
+
+    // Attaches a counter to the phase. Call sites should pass values that are cheap to
+    // compute, since they are evaluated even when nothing is recorded.
+    void count(const char *counter, uint64_t value)
+    {
+        if (stats)
+            stats->count(phase, counter, value);
+    }
+
+private:
+    CompileStats *stats;
+    size_t phase = 0;
+};
+#else
+class PhaseTimer
+{
+public:
+    PhaseTimer(CompileStats *, const char *) {}
+    void count(const char *, uint64_t) {}
+};
+#endif
+
+#endif
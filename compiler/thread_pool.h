@@ -0,0 +1,156 @@
+#ifndef MINI_COMPILER_THREAD_POOL_H
+#define MINI_COMPILER_THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs a fixed set of tasks on worker threads. Every worker owns a queue holding a
+// contiguous block of the task indices and takes from its front; a worker whose queue
+// is empty steals from the back of another's, so uneven tasks still keep every core
+// busy. The calling thread works as worker 0, and the threads are kept between runs.
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(size_t thread_count = 0)
+    {
+        if (thread_count == 0)
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < thread_count; i++)
+        {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (size_t worker = 1; worker < thread_count; worker++)
+        {
+            threads.emplace_back([this, worker] { workerLoop(worker); });
+        }
+    }
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    size_t threadCount() const { return queues.size(); }
+
+    // Calls task(worker, index) for every index in [0, count) and waits for all of them.
+    // worker is below threadCount() and no two calls with the same worker overlap, so
+    // callers can keep per-worker state such as an Arena and an Interner.
+    void run(size_t count, const std::function<void(size_t, size_t)> &task)
+    {
+        size_t workers = queues.size();
+        for (size_t worker = 0; worker < workers; worker++)
+        {
+            std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+            for (size_t index = count * worker / workers; index < count * (worker + 1) / workers; index++)
+            {
+                queues[worker]->tasks.push_back(index);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &task;
+            busy_workers = workers - 1;
+            generation++;
+        }
+        wake.notify_all();
+        work(0, task);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy_workers == 0; });
+        current = nullptr;
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex mutex; // guards the fields below
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t, size_t)> *current = nullptr;
+    size_t busy_workers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void workerLoop(size_t worker)
+    {
+        uint64_t seen = 0;
+        while (true)
+        {
+            const std::function<void(size_t, size_t)> *task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                task = current;
+            }
+            work(worker, *task);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy_workers == 0)
+                done.notify_one();
+        }
+    }
+
+    // Runs tasks from the worker's own queue, then steals until every queue is empty.
+    // Tasks are only added by run(), so once all queues are empty no more will appear.
+    void work(size_t worker, const std::function<void(size_t, size_t)> &task)
+    {
+        size_t index;
+        while (takeOwn(worker, index) || steal(worker, index))
+        {
+            task(worker, index);
+        }
+    }
+
+    bool takeOwn(size_t worker, size_t &index)
+    {
+        Queue &queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        index = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    bool steal(size_t thief, size_t &index)
+    {
+        for (size_t offset = 1; offset < queues.size(); offset++)
+        {
+            Queue &queue = *queues[(thief + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                index = queue.tasks.back();
+                queue.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "token.h"
+
+const char *tokenTypeName(TokenType type)
+{
+    switch (type)
+    {
+    case TokenType::KEYWORD_INT:
+        return "KEYWORD_INT";
+    case TokenType::KEYWORD_IF:
+        return "KEYWORD_IF";
+    case TokenType::KEYWORD_WHILE:
+        return "KEYWORD_WHILE";
+    case TokenType::KEYWORD_RETURN:
+        return "KEYWORD_RETURN";
+    case TokenType::IDENTIFIER:
+        return "IDENTIFIER";
+    case TokenType::INTEGER_LITERAL:
+        return "INTEGER_LITERAL";
+    case TokenType::OPERATOR_PLUS:
+        return "OPERATOR_PLUS";
+    case TokenType::OPERATOR_MINUS:
+        return "OPERATOR_MINUS";
+    case TokenType::OPERATOR_MULTIPLY:
+        return "OPERATOR_MULTIPLY";
+    case TokenType::OPERATOR_DIVIDE:
+        return "OPERATOR_DIVIDE";
+    case TokenType::OPERATOR_ASSIGN:
+        return "OPERATOR_ASSIGN";
+    case TokenType::PUNCTUATION_SEMICOLON:
+        return "PUNCTUATION_SEMICOLON";
+    case TokenType::PUNCTUATION_LPAREN:
+        return "PUNCTUATION_LPAREN";
+    case TokenType::PUNCTUATION_RPAREN:
+        return "PUNCTUATION_RPAREN";
+    case TokenType::END_OF_FILE:
+        return "END_OF_FILE";
+    case TokenType::UNKNOWN:
+        return "UNKNOWN";
+    default:
+        return "ERROR";
+    }
+}
+
+std::string tokenTypeToString(TokenType type)
+{
+    return tokenTypeName(type);
+}
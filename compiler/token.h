@@ -0,0 +1,58 @@
+#ifndef MINI_COMPILER_TOKEN_H
+#define MINI_COMPILER_TOKEN_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Defines all the different kinds of tokens our language recognizes.
+enum class TokenType
+{
+    KEYWORD_INT,
+    KEYWORD_IF,
+    KEYWORD_WHILE,
+    KEYWORD_RETURN,
+    IDENTIFIER,
+    INTEGER_LITERAL,
+    OPERATOR_PLUS,
+    OPERATOR_MINUS,
+    OPERATOR_MULTIPLY,
+    OPERATOR_DIVIDE,
+    OPERATOR_ASSIGN,
+    PUNCTUATION_SEMICOLON,
+    PUNCTUATION_LPAREN,
+    PUNCTUATION_RPAREN,
+    END_OF_FILE,
+    UNKNOWN
+};
+
+// Symbol ID of tokens that are not identifiers.
+constexpr uint32_t NO_SYMBOL = UINT32_MAX;
+
+// Number of an INTEGER_LITERAL whose value does not fit in int64_t. Literals have no
+// sign, so no valid literal has a negative number.
+constexpr int64_t LITERAL_OUT_OF_RANGE = -1;
+
+// Represents a single token with its type and the actual text (value).
+// The value is a view into the source buffer, which must outlive the token.
+// Identifiers also carry their interned symbol ID, and integer literals the value the
+// lexer converted them to. symbol sits next to type so a token stays 32 bytes.
+struct Token
+{
+    TokenType type;
+    uint32_t symbol = NO_SYMBOL;
+    std::string_view value;
+    int64_t number = 0;
+
+    Token() = default;
+    Token(TokenType type, std::string_view value, uint32_t symbol = NO_SYMBOL, int64_t number = 0)
+        : type(type), symbol(symbol), value(value), number(number) {}
+};
+
+// Helper function to convert a TokenType to a human-readable string for printing.
+std::string tokenTypeToString(TokenType type);
+
+// The same name, without building a std::string, for dumps of many tokens.
+const char *tokenTypeName(TokenType type);
+
+#endif
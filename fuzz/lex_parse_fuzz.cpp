@@ -0,0 +1,223 @@
+// libFuzzer target that feeds arbitrary bytes through lexing and parsing and checks the
+// optimized paths against their references, aborting on the first disagreement:
+//   - Lexer, with its SIMD run scanning and SWAR literals, against a byte-at-a-time
+//     model built from findRunEndScalar() and parseDecimalScalar()
+//   - parseDecimal() against parseDecimalScalar() on every digit run, and on the input
+//     itself mapped to digits, which reaches the long and zero-padded literals
+//   - lexing the chunks of splitAtWhitespace() and splitAtStatementBoundaries() against
+//     lexing the whole input, which lexParallel and parseProgramParallel rely on
+//   - FlatParser against Parser: the same diagnostics, and the same JSON lines
+// Build this once as is and once with -DMINI_COMPILER_SCALAR_LEXER, and with -mavx2
+// where available, to cover every run-scanning path.
+//
+// Build: clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address,undefined fuzz/lex_parse_fuzz.cpp compiler/*.cpp -lpthread -o lex_parse_fuzz
+// Run:   ./lex_parse_fuzz -max_len=4096 fuzz/corpus
+//
+// Compilers without libFuzzer can build a replay driver that runs the target once per
+// file, for the seed corpus or a crash file found elsewhere:
+//        g++ -std=c++17 -g -fsanitize=address,undefined -DMINI_COMPILER_FUZZ_REPLAY fuzz/lex_parse_fuzz.cpp compiler/*.cpp -lpthread -o lex_parse_replay
+//        ./lex_parse_replay fuzz/corpus
+#include "../compiler/compiler.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+
+#define FUZZ_CHECK(condition)                                                                    \
+    do                                                                                           \
+    {                                                                                            \
+        if (!(condition))                                                                        \
+        {                                                                                        \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n";      \
+            std::abort();                                                                        \
+        }                                                                                        \
+    } while (false)
+
+// The reference lexer: getNextToken() spelled out with the scalar helpers.
+class ReferenceLexer
+{
+public:
+    ReferenceLexer(std::string_view source, Interner &interner) : source(source), interner(interner) {}
+
+    Token next()
+    {
+        pos = findRunEndScalar(source, pos, CHAR_SPACE);
+        if (pos >= source.size())
+            return {TokenType::END_OF_FILE, source.substr(pos, 0)};
+        TokenType single = CHAR_TABLES.single_char_tokens[static_cast<unsigned char>(source[pos])];
+        if (single != TokenType::UNKNOWN)
+            return {single, source.substr(pos++, 1)};
+        uint8_t cls = charClass(source[pos]);
+        size_t start = pos;
+        if (cls & CHAR_DIGIT)
+        {
+            pos = findRunEndScalar(source, pos, CHAR_DIGIT);
+            std::string_view digits = source.substr(start, pos - start);
+            return {TokenType::INTEGER_LITERAL, digits, NO_SYMBOL, parseDecimalScalar(digits)};
+        }
+        if (cls & CHAR_ALPHA)
+        {
+            pos = findRunEndScalar(source, pos, CHAR_ALNUM);
+            std::string_view text = source.substr(start, pos - start);
+            TokenType keyword = lookupKeyword(text);
+            if (keyword != TokenType::IDENTIFIER)
+                return {keyword, text};
+            return {TokenType::IDENTIFIER, text, interner.intern(text)};
+        }
+        return {TokenType::UNKNOWN, source.substr(pos++, 1)};
+    }
+
+private:
+    std::string_view source;
+    Interner &interner;
+    size_t pos = 0;
+};
+
+bool sameToken(const Token &a, const Token &b)
+{
+    return a.type == b.type && a.value.data() == b.value.data() && a.value.size() == b.value.size() &&
+           a.symbol == b.symbol && a.number == b.number;
+}
+
+// Tokens of source up to END_OF_FILE, which is left out.
+std::vector<Token> lexAll(std::string_view source, Interner &interner)
+{
+    std::vector<Token> tokens;
+    Lexer lexer(source, interner);
+    for (Token token = lexer.getNextToken(); token.type != TokenType::END_OF_FILE; token = lexer.getNextToken())
+    {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+std::vector<Token> checkLexer(std::string_view source)
+{
+    Interner interner;
+    Interner reference_interner;
+    std::vector<Token> tokens = lexAll(source, interner);
+    ReferenceLexer reference(source, reference_interner);
+    for (const Token &token : tokens)
+    {
+        FUZZ_CHECK(sameToken(token, reference.next()));
+    }
+    FUZZ_CHECK(reference.next().type == TokenType::END_OF_FILE);
+    FUZZ_CHECK(interner.size() == reference_interner.size());
+    return tokens;
+}
+
+void checkParseDecimal(std::string_view source, const std::vector<Token> &tokens)
+{
+    for (const Token &token : tokens)
+    {
+        if (token.type == TokenType::INTEGER_LITERAL)
+            FUZZ_CHECK(parseDecimal(token.value) == parseDecimalScalar(token.value));
+    }
+    // Few bytes lex as long digit runs, so map them all to digits, zeros more often than
+    // the rest, and check every length.
+    std::string digits(source.size(), '0');
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        unsigned char byte = static_cast<unsigned char>(source[i]);
+        if (byte % 13 < 10)
+            digits[i] = static_cast<char>('0' + byte % 13);
+    }
+    std::string_view view = digits;
+    for (size_t length = 0; length <= view.size() && length <= 64; length++)
+    {
+        FUZZ_CHECK(parseDecimal(view.substr(0, length)) == parseDecimalScalar(view.substr(0, length)));
+    }
+}
+
+// Lexing each chunk in turn, into one Interner, must give the whole input's tokens.
+void checkChunks(std::string_view source, const std::vector<std::string_view> &chunks,
+                 const std::vector<Token> &expected)
+{
+    Interner interner;
+    std::vector<Token> tokens;
+    size_t covered = 0;
+    for (std::string_view chunk : chunks)
+    {
+        FUZZ_CHECK(chunk.data() == source.data() + covered);
+        covered += chunk.size();
+        std::vector<Token> chunk_tokens = lexAll(chunk, interner);
+        tokens.insert(tokens.end(), chunk_tokens.begin(), chunk_tokens.end());
+    }
+    FUZZ_CHECK(covered == source.size());
+    FUZZ_CHECK(tokens.size() == expected.size());
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        FUZZ_CHECK(sameToken(tokens[i], expected[i]));
+    }
+}
+
+void checkParsers(std::string_view source)
+{
+    Interner interner;
+    Arena arena;
+    std::vector<AstNode *> statements;
+    Diagnostics diagnostics(source);
+    Lexer lexer(source, interner);
+    bool ok = Parser(lexer, arena, diagnostics).parseProgram(statements);
+
+    FlatAst ast;
+    std::vector<FlatNodeRef> flat_statements;
+    Diagnostics flat_diagnostics(source);
+    Lexer flat_lexer(source, interner);
+    bool flat_ok = FlatParser(flat_lexer, ast, flat_diagnostics).parseProgram(flat_statements);
+
+    FUZZ_CHECK(ok == flat_ok);
+    FUZZ_CHECK(ok == diagnostics.empty());
+    FUZZ_CHECK(diagnostics.size() == flat_diagnostics.size());
+    for (size_t i = 0; i < diagnostics.size(); i++)
+    {
+        FUZZ_CHECK(diagnostics[i].code == flat_diagnostics[i].code);
+        FUZZ_CHECK(diagnostics[i].offset == flat_diagnostics[i].offset);
+        FUZZ_CHECK(diagnostics[i].length == flat_diagnostics[i].length);
+    }
+    std::ostringstream tree_json;
+    std::ostringstream flat_json;
+    printAstJson(statements, tree_json);
+    printFlatAstJson(ast, flat_statements, flat_json);
+    FUZZ_CHECK(tree_json.str() == flat_json.str());
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    std::string_view source(reinterpret_cast<const char *>(data), size);
+    std::vector<Token> tokens = checkLexer(source);
+    checkParseDecimal(source, tokens);
+    for (size_t chunk_count : {2, 3, 7})
+    {
+        checkChunks(source, splitAtWhitespace(source, chunk_count), tokens);
+        checkChunks(source, splitAtStatementBoundaries(source, chunk_count), tokens);
+    }
+    checkParsers(source);
+    return 0;
+}
+
+#ifdef MINI_COMPILER_FUZZ_REPLAY
+// Runs the target on every file named, directories included.
+int main(int argc, char **argv)
+{
+    std::vector<std::string> paths(argv + 1, argv + argc);
+    if (!expandInputPaths(paths))
+        return 1;
+    for (const std::string &path : paths)
+    {
+        SourceFile file;
+        if (!file.open(path))
+            return 1;
+        // A copy of exactly the file's size, so reads past the end are caught.
+        std::vector<uint8_t> data(file.text().begin(), file.text().end());
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+    std::cout << "Ran " << paths.size() << " inputs.\n";
+    return 0;
+}
+#endif
@@ -1,146 +1,108 @@
+// Token dump driver for the lexer in compiler/.
+// Build: g++ -std=c++17 -O2 lexer.cpp compiler/*.cpp -lpthread -o lexer
+#include "compiler/interner.h"
+#include "compiler/lexer.h"
+#include "compiler/output.h"
+#include "compiler/parallel_lexer.h"
+#include "compiler/source_file.h"
+#include "compiler/token.h"
+
 #include <iostream>
-#include <string>
+#include <string_view>
 #include <vector>
-#include <cctype>
-
-// Defines all the different kinds of tokens our language recognizes.
-enum class TokenType {
-    KEYWORD_INT,
-    IDENTIFIER,
-    INTEGER_LITERAL,
-    OPERATOR_PLUS,
-    OPERATOR_MINUS,
-    OPERATOR_MULTIPLY,
-    OPERATOR_DIVIDE,
-    OPERATOR_ASSIGN,
-    PUNCTUATION_SEMICOLON,
-    END_OF_FILE,
-    UNKNOWN
-};
-
-// Represents a single token with its type and the actual text (value).
-struct Token {
-    TokenType type;
-    std::string value;
-};
-
-// This class is responsible for turning a string of source code into a list of tokens.
-class Lexer {
-public:
-    Lexer(const std::string& source)
-        : source_code(source), current_pos(0) {}
-
-    Token getNextToken() {
-        skipWhitespace();
-
-        if (current_pos >= source_code.length()) {
-            return {TokenType::END_OF_FILE, ""};
-        }
-
-        char current_char = source_code[current_pos];
 
-        if (current_char == '+') {
-            current_pos++;
-            return {TokenType::OPERATOR_PLUS, "+"};
-        }
-        if (current_char == '-') {
-            current_pos++;
-            return {TokenType::OPERATOR_MINUS, "-"};
-        }
-        if (current_char == '*') {
-            current_pos++;
-            return {TokenType::OPERATOR_MULTIPLY, "*"};
-        }
-        if (current_char == '/') {
-            current_pos++;
-            return {TokenType::OPERATOR_DIVIDE, "/"};
-        }
-        if (current_char == '=') {
-            current_pos++;
-            return {TokenType::OPERATOR_ASSIGN, "="};
-        }
-        if (current_char == ';') {
-            current_pos++;
-            return {TokenType::PUNCTUATION_SEMICOLON, ";"};
-        }
-
-        if (std::isdigit(current_char)) {
-            return readInteger();
-        }
+// Writes one token as a "Type: ..., Value: '...'" line.
+static void printToken(OutputBuffer& out, const Token& token) {
+    out.write("Type: ");
+    out.write(tokenTypeName(token.type));
+    out.write(", Value: '");
+    out.write(token.value);
+    out.put('\'');
+    if (token.symbol != NO_SYMBOL) {
+        out.write(", Symbol: ");
+        out.writeInt(token.symbol);
+    }
+    out.put('\n');
+}
 
-        if (std::isalpha(current_char)) {
-            return readIdentifierOrKeyword();
+// Writes one token as a JSON object on its own line, such as
+// {"type":"INTEGER_LITERAL","value":"10","number":10}. Identifiers also carry "symbol",
+// and a literal too large for 64 bits has "number":null.
+static void printTokenJson(OutputBuffer& out, const Token& token) {
+    out.write("{\"type\":\"");
+    out.write(tokenTypeName(token.type));
+    out.write("\",\"value\":");
+    out.writeJsonString(token.value);
+    if (token.symbol != NO_SYMBOL) {
+        out.write(",\"symbol\":");
+        out.writeInt(token.symbol);
+    }
+    if (token.type == TokenType::INTEGER_LITERAL) {
+        out.write(",\"number\":");
+        if (token.number == LITERAL_OUT_OF_RANGE) {
+            out.write("null");
+        } else {
+            out.writeInt(token.number);
         }
-
-        current_pos++;
-        return {TokenType::UNKNOWN, std::string(1, current_char)};
     }
+    out.write("}\n");
+}
 
-private:
-    std::string source_code;
-    size_t current_pos;
-
-    void skipWhitespace() {
-        while (current_pos < source_code.length() && std::isspace(source_code[current_pos])) {
-            current_pos++;
+// The entry point of our program. Tokenizes the file named on the command line
+// ("-" for stdin), or a built-in example when no file is given. With --json, every
+// token is printed as a JSON line for other tools instead. With --parallel, the input
+// is lexed on all cores by lexParallel, which prints the same tokens.
+int main(int argc, char** argv) {
+    bool json = false;
+    bool parallel = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--parallel") {
+            parallel = true;
+        } else {
+            path = argv[i];
         }
     }
 
-    Token readInteger() {
-        size_t start_pos = current_pos;
-        while (current_pos < source_code.length() && std::isdigit(source_code[current_pos])) {
-            current_pos++;
+    SourceFile source;
+    std::string_view code = "int result = 10 + 20;";
+    if (path) {
+        if (!source.open(path)) {
+            return 1;
         }
-        std::string value = source_code.substr(start_pos, current_pos - start_pos);
-        return {TokenType::INTEGER_LITERAL, value};
+        code = source.text();
+    } else if (!json) {
+        std::cout << "Tokenizing the following code:\n\"" << code << "\"\n\n";
     }
 
-    Token readIdentifierOrKeyword() {
-        size_t start_pos = current_pos;
-        while (current_pos < source_code.length() && std::isalnum(source_code[current_pos])) {
-            current_pos++;
+    // Tokens are formatted into one buffer and reach std::cout in large writes.
+    OutputBuffer out(std::cout);
+    auto print = [&](const Token& token) {
+        if (json) {
+            printTokenJson(out, token);
+        } else {
+            printToken(out, token);
         }
-        std::string value = source_code.substr(start_pos, current_pos - start_pos);
-
-        if (value == "int") {
-            return {TokenType::KEYWORD_INT, value};
+    };
+
+    Interner interner;
+    if (parallel) {
+        std::vector<Token> tokens;
+        lexParallel(code, interner, tokens);
+        for (const Token& token : tokens) {
+            print(token);
         }
-
-        return {TokenType::IDENTIFIER, value};
+        print(Token(TokenType::END_OF_FILE, code.substr(code.size())));
+        return 0;
     }
-};
-
-// Helper function to convert a TokenType to a human-readable string for printing.
-std::string tokenTypeToString(TokenType type) {
-    switch (type) {
-        case TokenType::KEYWORD_INT:         return "KEYWORD_INT";
-        case TokenType::IDENTIFIER:          return "IDENTIFIER";
-        case TokenType::INTEGER_LITERAL:     return "INTEGER_LITERAL";
-        case TokenType::OPERATOR_PLUS:       return "OPERATOR_PLUS";
-        case TokenType::OPERATOR_MINUS:      return "OPERATOR_MINUS";
-        case TokenType::OPERATOR_MULTIPLY:   return "OPERATOR_MULTIPLY";
-        case TokenType::OPERATOR_DIVIDE:     return "OPERATOR_DIVIDE";
-        case TokenType::OPERATOR_ASSIGN:     return "OPERATOR_ASSIGN";
-        case TokenType::PUNCTUATION_SEMICOLON: return "PUNCTUATION_SEMICOLON";
-        case TokenType::END_OF_FILE:         return "END_OF_FILE";
-        case TokenType::UNKNOWN:             return "UNKNOWN";
-        default:                             return "ERROR";
-    }
-}
-
-// The entry point of our program.
-int main() { 
-    std::string code = "int result = 10 + 20;";
-
-    std::cout << "Tokenizing the following code:\n\"" << code << "\"\n\n";
-
-    Lexer lexer(code);
-
+    Lexer lexer(code, interner);
     Token token;
     do {
         token = lexer.getNextToken();
-        std::cout << "Type: " << tokenTypeToString(token.type)
-                  << ", Value: '" << token.value << "'\n";
+        print(token);
     } while (token.type != TokenType::END_OF_FILE);
 
     return 0;
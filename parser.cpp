@@ -1,344 +1,249 @@
+// Command-line driver for the compiler library in compiler/.
+// Build: g++ -std=c++17 -O2 parser.cpp compiler/*.cpp -lpthread -o parser
+//    or, against the static library (see compiler/compiler.h):
+//        g++ -std=c++17 -O2 parser.cpp build/libminicompiler.a -lpthread -o parser
+#include "compiler/compiler.h"
+
+#include <csignal>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <cctype>
-#include <memory>
 
-// Defines all the different kinds of tokens our language recognizes.
-enum class TokenType
-{
-    KEYWORD_INT,
-    IDENTIFIER,
-    INTEGER_LITERAL,
-    OPERATOR_PLUS,
-    OPERATOR_MINUS,
-    OPERATOR_MULTIPLY,
-    OPERATOR_DIVIDE,
-    OPERATOR_ASSIGN,
-    PUNCTUATION_SEMICOLON,
-    END_OF_FILE,
-    UNKNOWN
-};
+// The server being run by --serve, for the SIGINT and SIGTERM handler to stop.
+static CompileServer *active_server = nullptr;
 
-// Represents a single token with its type and the actual text (value).
-struct Token
+static void stopServer(int)
 {
-    TokenType type;
-    std::string value;
-};
+    if (active_server)
+        active_server->stop();
+}
 
-// This class is responsible for turning a string of source code into a list of tokens.
-class Lexer
+// The entry point of our program. Parses the file named on the command line
+// ("-" for stdin), or a built-in example when no file is given.
+// Options:
+//   --flat       build the compact FlatAst instead of the pointer-linked tree; --fold,
+//                --check, --live, --run, --jit and --cache are rejected with it, with
+//                --write-image and with --read-image
+//   --parallel   parse statements on all cores (pointer-linked tree only); with
+//                --write-image, lex the image's token stream on all cores
+//   --fold       fold constant expressions before printing (pointer-linked tree only)
+//   --check      report redeclared names and names read before their declaration, and
+//                fail if there are any (pointer-linked tree only)
+//   --live NAMES drop the declarations that the comma-separated variables NAMES do not
+//                depend on, before folding or running (pointer-linked tree only); a
+//                name that does not occur in the program is an error
+//   --run        compile to bytecode and print the variables instead of the AST
+//   --jit        like --run, but execute native code where the platform supports it
+//   --json       print the AST as JSON lines, one object per node, for other tools
+//   --cache FILE like --run, but reuse declarations compiled by earlier runs from FILE
+//                and save the updated cache back to it
+//   --batch      compile every file and directory named on the command line on all
+//                cores, printing each file's output under a "File:" header in order
+//   --stats      print the time and counters of each phase to stderr at the end
+//   --trace FILE write the phases to FILE as Chrome trace-event JSON
+//   --write-image FILE
+//                like --flat, and also write the tokens and FlatAst to FILE as a parse image
+//   --read-image FILE
+//                print the FlatAst stored in the parse image FILE, without lexing or parsing
+//   --serve ADDRESS
+//                compile requests sent to the TCP port ADDRESS on 127.0.0.1, or to the Unix
+//                socket at path ADDRESS, with the other options, until SIGINT or SIGTERM
+//                (see CompileServer); with --stats, print its counters and latencies at exit
+int main(int argc, char **argv)
 {
-public:
-    Lexer(const std::string &source)
-        : source_code(source), current_pos(0) {}
-
-    Token getNextToken()
+    DriverOptions options;
+    bool use_batch = false;
+    const char *cache_path = nullptr;
+    bool use_stats = false;
+    const char *trace_path = nullptr;
+    const char *read_image_path = nullptr;
+    const char *serve_address = nullptr;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++)
     {
-        skipWhitespace();
-
-        if (current_pos >= source_code.length())
-        {
-            return {TokenType::END_OF_FILE, ""};
-        }
-
-        char current_char = source_code[current_pos];
-
-        if (current_char == '+')
-        {
-            current_pos++;
-            return {TokenType::OPERATOR_PLUS, "+"};
-        }
-        if (current_char == '-')
-        {
-            current_pos++;
-            return {TokenType::OPERATOR_MINUS, "-"};
-        }
-        if (current_char == '*')
-        {
-            current_pos++;
-            return {TokenType::OPERATOR_MULTIPLY, "*"};
-        }
-        if (current_char == '/')
-        {
-            current_pos++;
-            return {TokenType::OPERATOR_DIVIDE, "/"};
-        }
-        if (current_char == '=')
-        {
-            current_pos++;
-            return {TokenType::OPERATOR_ASSIGN, "="};
-        }
-        if (current_char == ';')
-        {
-            current_pos++;
-            return {TokenType::PUNCTUATION_SEMICOLON, ";"};
-        }
-
-        if (std::isdigit(current_char))
-        {
-            return readInteger();
-        }
-
-        if (std::isalpha(current_char))
-        {
-            return readIdentifierOrKeyword();
-        }
-
-        current_pos++;
-        return {TokenType::UNKNOWN, std::string(1, current_char)};
+        std::string_view arg = argv[i];
+        if (arg == "--flat")
+            options.flat = true;
+        else if (arg == "--parallel")
+            options.parallel = true;
+        else if (arg == "--fold")
+            options.fold = true;
+        else if (arg == "--check")
+            options.check = true;
+        else if (arg == "--live" && i + 1 < argc)
+            options.live = argv[++i];
+        else if (arg == "--run")
+            options.run = true;
+        else if (arg == "--jit")
+            options.jit = true;
+        else if (arg == "--json")
+            options.json = true;
+        else if (arg == "--cache" && i + 1 < argc)
+            cache_path = argv[++i];
+        else if (arg == "--batch")
+            use_batch = true;
+        else if (arg == "--stats")
+            use_stats = true;
+        else if (arg == "--trace" && i + 1 < argc)
+            trace_path = argv[++i];
+        else if (arg == "--write-image" && i + 1 < argc)
+        {
+            options.flat = true;
+            options.image = argv[++i];
+        }
+        else if (arg == "--read-image" && i + 1 < argc)
+            read_image_path = argv[++i];
+        else if (arg == "--serve" && i + 1 < argc)
+            serve_address = argv[++i];
+        else
+            paths.push_back(argv[i]);
     }
 
-private:
-    std::string source_code;
-    size_t current_pos;
-
-    void skipWhitespace()
+    // The FlatAst is only printed, so options that check, transform or run the tree would be
+    // ignored.
+    const char *flat_option = read_image_path ? "--read-image"
+                              : options.image ? "--write-image"
+                              : options.flat  ? "--flat"
+                                              : nullptr;
+    const char *tree_option = options.run   ? "--run"
+                              : options.jit   ? "--jit"
+                              : options.fold  ? "--fold"
+                              : options.check ? "--check"
+                              : options.live  ? "--live"
+                              : cache_path    ? "--cache"
+                                              : nullptr;
+    if (flat_option && tree_option)
     {
-        while (current_pos < source_code.length() && std::isspace(source_code[current_pos]))
-        {
-            current_pos++;
-        }
+        std::cerr << "Error: " << tree_option << " cannot be combined with " << flat_option << "\n";
+        return 1;
     }
 
-    Token readInteger()
+    CompileStats stats;
+    if (use_stats || trace_path)
     {
-        size_t start_pos = current_pos;
-        while (current_pos < source_code.length() && std::isdigit(source_code[current_pos]))
-        {
-            current_pos++;
-        }
-        std::string value = source_code.substr(start_pos, current_pos - start_pos);
-        return {TokenType::INTEGER_LITERAL, value};
+#ifdef MINI_COMPILER_NO_STATS
+        std::cerr << "Note: statistics were compiled out, nothing will be recorded.\n";
+#endif
+        options.stats = &stats;
     }
-
-    Token readIdentifierOrKeyword()
+    // Prints and writes what was recorded; returns false if the trace cannot be written.
+    auto reportStats = [&]
     {
-        size_t start_pos = current_pos;
-        while (current_pos < source_code.length() && std::isalnum(source_code[current_pos]))
-        {
-            current_pos++;
-        }
-        std::string value = source_code.substr(start_pos, current_pos - start_pos);
-
-        if (value == "int")
+        if (use_stats)
+            stats.print(std::cerr);
+        if (!trace_path)
+            return true;
+        std::ofstream trace(trace_path);
+        stats.writeTrace(trace);
+        if (!trace.flush())
         {
-            return {TokenType::KEYWORD_INT, value};
+            std::cerr << "Error: Cannot write " << trace_path << "\n";
+            return false;
         }
+        return true;
+    };
 
-        return {TokenType::IDENTIFIER, value};
-    }
-};
-
-// Helper function to convert a TokenType to a human-readable string for printing.
-std::string tokenTypeToString(TokenType type)
-{
-    switch (type)
+    if (serve_address)
     {
-    case TokenType::KEYWORD_INT:
-        return "KEYWORD_INT";
-    case TokenType::IDENTIFIER:
-        return "IDENTIFIER";
-    case TokenType::INTEGER_LITERAL:
-        return "INTEGER_LITERAL";
-    case TokenType::OPERATOR_PLUS:
-        return "OPERATOR_PLUS";
-    case TokenType::OPERATOR_MINUS:
-        return "OPERATOR_MINUS";
-    case TokenType::OPERATOR_MULTIPLY:
-        return "OPERATOR_MULTIPLY";
-    case TokenType::OPERATOR_DIVIDE:
-        return "OPERATOR_DIVIDE";
-    case TokenType::OPERATOR_ASSIGN:
-        return "OPERATOR_ASSIGN";
-    case TokenType::PUNCTUATION_SEMICOLON:
-        return "PUNCTUATION_SEMICOLON";
-    case TokenType::END_OF_FILE:
-        return "END_OF_FILE";
-    case TokenType::UNKNOWN:
-        return "UNKNOWN";
-    default:
-        return "ERROR";
+        if (cache_path || options.image || use_batch || read_image_path)
+        {
+            std::cerr << "Error: --serve cannot be combined with --cache, --write-image, --batch or --read-image\n";
+            return 1;
+        }
+        WorkStealingPool pool;
+        CompileServer server(options, pool);
+        if (!server.listen(serve_address))
+            return 1;
+        std::cerr << "Serving on " << (server.port() ? "port " + std::to_string(server.port()) : serve_address)
+                  << "\n";
+        active_server = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        bool ok = server.serve();
+        active_server = nullptr;
+        if (use_stats)
+            printServerStats(server.stats(), std::cerr);
+        return ok ? 0 : 1;
     }
-}
 
-// Base struct for all Abstract Syntax Tree nodes.
-struct AstNode
-{
-    virtual ~AstNode() = default;
-};
-
-// Represents a number literal in the code.
-struct NumberNode : public AstNode
-{
-    Token token;
-    NumberNode(Token t) : token(t) {}
-};
-
-// Represents a binary operation (e.g., 10 + 20).
-struct BinaryOpNode : public AstNode
-{
-    std::unique_ptr<AstNode> left;
-    Token op;
-    std::unique_ptr<AstNode> right;
-    BinaryOpNode(std::unique_ptr<AstNode> l, Token o, std::unique_ptr<AstNode> r)
-        : left(std::move(l)), op(o), right(std::move(r)) {}
-};
-
-// Represents a variable declaration statement.
-struct VarDeclNode : public AstNode
-{
-    Token type;
-    Token identifier;
-    std::unique_ptr<AstNode> expression;
-    VarDeclNode(Token t, Token id, std::unique_ptr<AstNode> expr)
-        : type(t), identifier(id), expression(std::move(expr)) {}
-};
-
-// This class takes a list of tokens and builds an Abstract Syntax Tree.
-class Parser
-{
-public:
-    Parser(const std::vector<Token> &tokens) : tokens(tokens), current_token_idx(0) {}
-    std::unique_ptr<AstNode> parse() { return parseStatement(); }
-
-private:
-    std::vector<Token> tokens;
-    size_t current_token_idx;
-
-    Token &peek() { return tokens[current_token_idx]; }
-    void advance()
+    if (read_image_path)
     {
-        if (current_token_idx < tokens.size())
-            current_token_idx++;
+        bool ok = printParseImage(read_image_path, options, std::cout, std::cerr);
+        if (!reportStats())
+            return 1;
+        return ok ? 0 : 1;
     }
 
-    std::unique_ptr<AstNode> parseStatement()
+    if (use_batch)
     {
-        if (peek().type == TokenType::KEYWORD_INT)
-            return parseVariableDeclaration();
-        return nullptr;
+        if (cache_path || options.image)
+        {
+            std::cerr << "Error: " << (cache_path ? "--cache" : "--write-image") << " cannot be combined with --batch\n";
+            return 1;
+        }
+        if (!expandInputPaths(paths))
+            return 1;
+        options.parallel = false; // the files themselves are spread over the cores
+        WorkStealingPool pool;
+        std::vector<BatchResult> results = compileBatch(paths, options, pool);
+        size_t failed = 0;
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            std::cout << "File: " << paths[i] << "\n"
+                      << results[i].output;
+            std::cout.flush();
+            if (!results[i].errors.empty())
+                std::cerr << "File: " << paths[i] << "\n"
+                          << results[i].errors;
+            failed += !results[i].ok;
+        }
+        std::cerr << "Batch: " << results.size() << " files, " << failed << " failed\n";
+        if (!reportStats())
+            return 1;
+        return failed == 0 ? 0 : 1;
     }
 
-    std::unique_ptr<AstNode> parseVariableDeclaration()
+    SourceFile source;
+    std::string_view code = "int result = 10 ;";
+    if (!paths.empty())
     {
-        Token type = peek();
-        advance(); // consume int
-
-        // ensure the next token is an identifier
-        if (peek().type != TokenType::IDENTIFIER)
-        {
-            std::cerr << "Error: Expected an identifier after int\n";
-            return nullptr;
-        }
-        Token identifier = peek();
-        advance(); // consume the identifier
-
-        if (peek().type != TokenType::OPERATOR_ASSIGN)
-        {
-            std::cerr << "Error: Expected equals sign\n";
-            return nullptr;
-        }
-        advance(); // consume equals
-
-        auto expression = parseExpression();
-        if (!expression)
-        {
-            return nullptr;
-        }
-
-        if (peek().type != TokenType::PUNCTUATION_SEMICOLON)
-        {
-            std::cerr << "Error: Expected semicolon\n";
-            return nullptr;
-        }
-        advance(); // consume semicolon
-
-        return std::make_unique<VarDeclNode>(type, identifier, std::move(expression));
+        PhaseTimer phase(options.stats, "read");
+        if (!source.open(paths.back()))
+            return 1;
+        code = source.text();
+        phase.count("bytes", code.size());
     }
-
-    std::unique_ptr<AstNode> parseExpression()
+    else if (!options.json)
     {
-        auto left = parseTerm();
-        while (peek().type == TokenType::OPERATOR_PLUS || peek().type == TokenType::OPERATOR_MINUS)
-        {
-            Token op = peek();
-            advance();
-            auto right = parseTerm();
-            if (!right)
-            {
-                std::cerr << "Error: Expected a number or identifier after operator\n";
-                return nullptr;
-            }
-            left = std::make_unique<BinaryOpNode>(std::move(left), op, std::move(right));
-        }
-        return left;
+        std::cout << "Input Code:\n"
+                  << code << "\n\n";
     }
 
-    std::unique_ptr<AstNode> parseTerm()
+    CompileCache cache;
+    if (cache_path)
     {
-        Token token = peek();
-        if (token.type == TokenType::INTEGER_LITERAL)
+        if (options.check || options.live)
         {
-            advance();
-            return std::make_unique<NumberNode>(token);
+            std::cerr << "Error: " << (options.check ? "--check" : "--live") << " cannot be combined with --cache\n";
+            return 1;
         }
-        return nullptr;
+        if (!cache.load(cache_path))
+            return 1;
+        options.cache = &cache;
     }
-};
 
-// Helper function to print the AST for verification.
-void printAst(const AstNode *node, int indent = 0)
-{
-    if (!node)
-        return;
-    std::string indentation(indent * 2, ' ');
-    if (auto p = dynamic_cast<const VarDeclNode *>(node))
-    {
-        std::cout << indentation << "VarDecl: " << p->identifier.value << " (" << p->type.value << ")\n";
-        std::cout << indentation << "  Value:\n";
-        printAst(p->expression.get(), indent + 2);
-    }
-    else if (auto p = dynamic_cast<const BinaryOpNode *>(node))
-    {
-        std::cout << indentation << "BinaryOp: " << p->op.value << "\n";
-        std::cout << indentation << "  Left:\n";
-        printAst(p->left.get(), indent + 2);
-        std::cout << indentation << "  Right:\n";
-        printAst(p->right.get(), indent + 2);
-    }
-    else if (auto p = dynamic_cast<const NumberNode *>(node))
+    CompilerContext context;
+    bool ok = compileSource(code, options, context, std::cout, std::cerr);
+    if (cache_path)
     {
-        std::cout << indentation << "Number: " << p->token.value << "\n";
+        std::cerr << "Cache: " << cache.hits() << " hits, " << cache.misses() << " misses, " << cache.size()
+                  << " entries\n";
+        if (!cache.save(cache_path))
+            return 1;
     }
-}
-
-// The entry point of our program.
-int main()
-{
-    std::string code = "int result = 10 ;";
-    std::cout << "Input Code:\n"
-              << code << "\n\n";
-
-    Lexer lexer(code);
-    std::vector<Token> tokens;
-    Token token;
-    do
-    {
-        token = lexer.getNextToken();
-        tokens.push_back(token);
-    } while (token.type != TokenType::END_OF_FILE);
-
-    std::cout << "Parser Output (Abstract Syntax Tree):\n";
-    Parser parser(tokens);
-    auto ast_root = parser.parse();
-    if (!ast_root)
-    {
-        std::cerr << "Parsing failed.\n";
+    if (!reportStats())
         return 1;
-    }
-    printAst(ast_root.get());
-
-    return 0;
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,96 @@
+// Checks that --parallel --stats reports the same parse counters as a serial parse: the
+// tokens, statements, nodes and bytes of the chunks must add up to what one Lexer and
+// Arena would count. Exits with status 1 and prints the mismatches otherwise.
+//
+// Build: g++ -std=c++17 -O2 tests/parallel_stats_test.cpp compiler/*.cpp -lpthread -o parallel_stats_test
+#include "../compiler/compiler.h"
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+int failures = 0;
+
+void expectEqual(const char *what, uint64_t serial, uint64_t parallel)
+{
+    if (serial == parallel)
+        return;
+    std::cerr << "FAIL " << what << ": serial " << serial << ", parallel " << parallel << "\n";
+    failures++;
+}
+
+// The counters of the single "parse" phase in stats, in recording order.
+std::vector<std::pair<const char *, uint64_t>> parseCounters(const CompileStats &stats)
+{
+    for (const CompileStats::Phase &phase : stats.recorded())
+    {
+        if (std::strcmp(phase.name, "parse") == 0)
+            return phase.counters;
+    }
+    return {};
+}
+
+} // namespace
+
+int main()
+{
+    // Several 64 KiB chunks' worth, so parseProgramParallel really splits it.
+    std::string source;
+    for (int i = 0; source.size() < 512 * 1024; i++)
+    {
+        source += "int v" + std::to_string(i) + " = " + std::to_string(i) + " * (v0 + 3) - 7;\n";
+    }
+
+    CompileStats serial_stats;
+    CompileStats parallel_stats;
+    for (bool parallel : {false, true})
+    {
+        DriverOptions options;
+        options.parallel = parallel;
+        options.stats = parallel ? &parallel_stats : &serial_stats;
+        CompilerContext context;
+        std::ostringstream out;
+        if (!compileSource(source, options, context, out, std::cerr))
+        {
+            std::cerr << "FAIL " << (parallel ? "parallel" : "serial") << " compilation\n";
+            return 1;
+        }
+    }
+    auto serial = parseCounters(serial_stats);
+    auto parallel = parseCounters(parallel_stats);
+    if (serial.size() != parallel.size())
+    {
+        std::cerr << "FAIL counter count: serial " << serial.size() << ", parallel " << parallel.size() << "\n";
+        return 1;
+    }
+    for (size_t i = 0; i < serial.size(); i++)
+    {
+        expectEqual(serial[i].first, serial[i].second, parallel[i].second);
+    }
+
+    // compileSource uses one chunk per core, so also split explicitly on single-core hosts.
+    Interner serial_interner;
+    Lexer lexer(source, serial_interner);
+    Arena arena;
+    std::vector<AstNode *> statements;
+    std::ostringstream errors;
+    Parser(lexer, arena, errors).parseProgram(statements);
+    Interner parallel_interner;
+    ParallelParseResult chunked = parseProgramParallel(source, parallel_interner, 4, errors);
+    size_t allocations = 0;
+    for (const auto &chunk_arena : chunked.arenas)
+    {
+        allocations += chunk_arena->allocations();
+    }
+    expectEqual("chunks", 4, chunked.arenas.size());
+    expectEqual("tokens in 4 chunks", lexer.tokenCount(), chunked.tokens);
+    expectEqual("nodes in 4 chunks", arena.allocations(), allocations);
+
+    if (failures)
+        return 1;
+    std::cout << "Parallel stats match the serial parse.\n";
+    return 0;
+}